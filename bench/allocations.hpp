@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Number of times global operator new was called since the program started.
+ *
+ * Counted by the replacement operator new in allocations.cpp, which every
+ * allocation in the benchmark binary goes through.
+ */
+uint64_t allocationCount();
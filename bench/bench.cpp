@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json11.hpp"
+#include "profiler.hpp"
+#include "simulation.hpp"
+#include "scenarios.hpp"
+#include "allocations.hpp"
+
+/*
+ * Runs every scenario under every variant of SimulationOptions and prints
+ * the results as JSON on stdout.
+ *
+ * usage: rj-bench [--ticks=N] [scenario...]
+ *
+ * Built with the profiler, which the per phase timings come from. Its
+ * overhead is included in ticks per second, compare runs of this binary
+ * against each other, not against `rj --headless`.
+ */
+
+constexpr uint64_t defaultTicks = 3000;
+constexpr std::string_view ticksOption = "--ticks=";
+// often enough for the profiler buffers to never wrap around, even with
+// every contact callback recorded
+constexpr uint64_t drainEveryTicks = 32;
+
+struct Variant {
+    const char *name;
+    SimulationOptions options;
+};
+
+const Variant variants[] = {
+    {"sensors", {}},
+    {"queries", {.explosionDetection = ExplosionDetection::QUERIES}},
+    {"queries+wheel", {.explosionDetection = ExplosionDetection::QUERIES, .timerWheel = true}},
+};
+
+double percentileMicroseconds(std::vector<uint64_t>& nanoseconds, double percentile) {
+    size_t index = static_cast<size_t>(percentile * (nanoseconds.size() - 1));
+    std::nth_element(nanoseconds.begin(), nanoseconds.begin() + index, nanoseconds.end());
+    return nanoseconds[index] / 1000.0;
+}
+
+json11::Json runScenario(const Scenario& scenario, const Variant& variant, uint64_t ticks) {
+    Simulation simulation(scenario.playerCount, variant.options);
+    scenario.setup(simulation);
+
+    std::vector<ProfileRecord> records;
+    // leave out whatever was recorded before
+    drainProfileRecords(records);
+    records.clear();
+
+    std::map<std::string, std::vector<uint64_t>> phaseDurations;
+    std::chrono::duration<double> elapsed{0};
+    uint64_t allocations = 0;
+    uint64_t lostEvents = 0;
+
+    for (uint64_t ticked = 0; ticked < ticks;) {
+        uint64_t batch = std::min(drainEveryTicks, ticks - ticked);
+
+        // only the stepping is measured, not the bookkeeping below
+        uint64_t allocationsBefore = allocationCount();
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < batch; i++) {
+            for (size_t player = 0; player < simulation.playerCount(); player++)
+                simulation.applyInput(player, scenario.input(simulation, player, simulation.tick()));
+            simulation.step();
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+        allocations += allocationCount() - allocationsBefore;
+
+        lostEvents += drainProfileRecords(records);
+        for (const ProfileRecord& record: records)
+            phaseDurations[record.name].push_back(record.end - record.begin);
+        records.clear();
+        ticked += batch;
+    }
+
+    json11::Json::object phases;
+    for (auto& [name, durations]: phaseDurations) {
+        phases[name] = json11::Json::object{
+            {"calls", static_cast<double>(durations.size())},
+            {"callsPerTick", static_cast<double>(durations.size()) / ticks},
+            {"p50Us", percentileMicroseconds(durations, 0.50)},
+            {"p99Us", percentileMicroseconds(durations, 0.99)},
+        };
+    }
+
+    return json11::Json::object{
+        {"scenario", scenario.name},
+        {"variant", variant.name},
+        {"players", static_cast<double>(scenario.playerCount)},
+        {"ticks", static_cast<double>(ticks)},
+        {"ticksPerSecond", ticks / elapsed.count()},
+        {"allocationsPerTick", static_cast<double>(allocations) / ticks},
+        {"lostProfileEvents", static_cast<double>(lostEvents)},
+        {"phases", phases},
+    };
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t ticks = defaultTicks;
+    std::vector<std::string_view> selected;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with(ticksOption)) {
+            ticks = std::stoull(std::string(arg.substr(ticksOption.size())));
+        } else {
+            selected.push_back(arg);
+        }
+    }
+
+    json11::Json::array results;
+    for (const Scenario& scenario: benchmarkScenarios()) {
+        bool isSelected = selected.empty()
+            || std::find(selected.begin(), selected.end(), scenario.name) != selected.end();
+        if (!isSelected) continue;
+        for (const Variant& variant: variants) {
+            results.push_back(runScenario(scenario, variant, ticks));
+            std::cerr << scenario.name << " (" << variant.name << ") done" << std::endl;
+        }
+    }
+
+    std::string dump;
+    json11::Json(json11::Json::object{
+        {"profiled", PROFILER_ENABLED},
+        {"results", results},
+    }).dump(dump);
+    std::cout << dump << std::endl;
+    return 0;
+}
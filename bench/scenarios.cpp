@@ -0,0 +1,82 @@
+#include "scenarios.hpp"
+
+#include "headless.hpp"
+
+constexpr float groundY = 10.0f;
+constexpr float groundHeight = 5.0f;
+constexpr float groundMargin = 10.0f;
+
+constexpr uint64_t volleyEveryTicks = 6 * 60;
+constexpr uint64_t chainShootEveryTicks = 8;
+constexpr uint64_t recoilEveryTicks = 200;
+constexpr uint64_t recoilChargeTicks = 30;
+
+constexpr int recoilPlatformRows = 16;
+constexpr int recoilPlatformColumns = 8;
+constexpr float recoilPlatformSpacing = 4.0f;
+
+// the default ground only fits a few players
+void addGroundUnderPlayers(Simulation& simulation) {
+    float left = simulation.getPlayer(0).box2dPosition().x - groundMargin;
+    float right = simulation.getPlayer(simulation.playerCount() - 1).box2dPosition().x + groundMargin;
+    simulation.addWall(b2Vec2{left, groundY}, b2Vec2{right - left, groundHeight});
+}
+
+// staggered platforms above the players, for recoil waves to fly between
+void addRecoilPlatforms(Simulation& simulation) {
+    addGroundUnderPlayers(simulation);
+    float left = simulation.getPlayer(0).box2dPosition().x;
+    for (int row = 0; row < recoilPlatformRows; row++) {
+        float stagger = (row % 2) * 0.5f * recoilPlatformSpacing;
+        for (int column = 0; column < recoilPlatformColumns; column++) {
+            b2Vec2 position = {
+                left + stagger + column * recoilPlatformSpacing,
+                -recoilPlatformSpacing * (row + 1)
+            };
+            simulation.addWall(position, b2Vec2{2.0f, 0.5f});
+        }
+    }
+}
+
+// the same script headless runs use, offset per player
+TickInput crowdInput(const Simulation& simulation, size_t playerIndex, uint64_t tick) {
+    return scriptedInput(tick + playerIndex * 7);
+}
+
+// the whole magazine at once, every player at the same point
+TickInput volleyInput(const Simulation& simulation, size_t playerIndex, uint64_t tick) {
+    TickInput input;
+    input.target = b2Vec2{0.0f, -15.0f};
+    input.leftPressed = tick % volleyEveryTicks < Player::maxRockets;
+    return input;
+}
+
+// rockets aimed at the ground next to the player fly through the
+// neighbour's explosions, setting each other off
+TickInput chainInput(const Simulation& simulation, size_t playerIndex, uint64_t tick) {
+    TickInput input;
+    b2Vec2 position = simulation.getPlayer(playerIndex).box2dPosition();
+    input.target = position + b2Vec2{1.5f, groundY};
+    input.leftPressed = (tick + playerIndex) % chainShootEveryTicks == 0;
+    return input;
+}
+
+// recoil off the ground, launching upwards into the platforms
+TickInput recoilInput(const Simulation& simulation, size_t playerIndex, uint64_t tick) {
+    TickInput input;
+    input.target = simulation.getPlayer(playerIndex).box2dPosition() + b2Vec2{0.0f, 1.0f};
+    uint64_t phase = (tick + playerIndex * 3) % recoilEveryTicks;
+    input.rightPressed = phase == 0;
+    input.rightReleased = phase == recoilChargeTicks;
+    return input;
+}
+
+const std::vector<Scenario>& benchmarkScenarios() {
+    static const std::vector<Scenario> scenarios = {
+        {"crowd", 64, addGroundUnderPlayers, crowdInput},
+        {"rocket-volleys", 32, addGroundUnderPlayers, volleyInput},
+        {"explosion-chains", 48, addGroundUnderPlayers, chainInput},
+        {"recoil-walls", 16, addRecoilPlatforms, recoilInput},
+    };
+    return scenarios;
+}
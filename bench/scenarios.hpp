@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "simulation.hpp"
+
+/**
+ * @brief A reproducible workload for the Simulation.
+ */
+struct Scenario {
+    const char *name;
+    size_t playerCount;
+    // adds terrain before the first step, besides the default ground
+    void (*setup)(Simulation& simulation);
+    // input for a player before the given tick
+    TickInput (*input)(const Simulation& simulation, size_t playerIndex, uint64_t tick);
+};
+
+/**
+ * @brief Every scenario the benchmark knows, in the order they are run.
+ */
+const std::vector<Scenario>& benchmarkScenarios();
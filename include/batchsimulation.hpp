@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "simulation.hpp"
+#include "workstealingpool.hpp"
+
+/**
+ * @brief Many independent simulations, stepped concurrently.
+ *
+ * Every Simulation owns its own world, players, contact listener, rockets
+ * and explosions, and is only ever stepped by one thread at a time, so
+ * they share nothing but the thread pool.
+ */
+class BatchSimulation {
+    WorkStealingPool pool;
+    std::deque<Simulation> worlds;
+public:
+    /**
+     * @brief Construct a new BatchSimulation object.
+     *
+     * @param worldCount How many independent simulations to run.
+     * @param playersPerWorld Players spawned in each of them.
+     * @param options Options every simulation is created with.
+     * @param threadCount Threads stepping them, including the caller of run().
+     */
+    BatchSimulation(
+        size_t worldCount,
+        size_t playersPerWorld = 1,
+        SimulationOptions options = {},
+        size_t threadCount = WorkStealingPool::defaultThreadCount()
+    );
+
+    /**
+     * @brief Steps every simulation a number of ticks, and waits for all of them.
+     *
+     * A whole simulation runs its ticks on a single thread, without waiting
+     * for the others in between.
+     *
+     * @param ticks How many steps each simulation advances.
+     * @param beforeStep Called as `beforeStep(worldIndex, simulation)` before
+     * every step, to apply input. Called concurrently for different worlds.
+     */
+    template<typename F>
+    void run(uint64_t ticks, const F& beforeStep) {
+        pool.parallelFor(worlds.size(), [this, ticks, &beforeStep](size_t worldIndex) {
+            Simulation& simulation = worlds[worldIndex];
+            for (uint64_t i = 0; i < ticks; i++) {
+                beforeStep(worldIndex, simulation);
+                simulation.step();
+            }
+        });
+    }
+
+    size_t size() const;
+    size_t threadCount() const;
+    Simulation& at(size_t worldIndex);
+    const Simulation& at(size_t worldIndex) const;
+};
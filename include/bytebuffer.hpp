@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Appends raw copies of trivially copyable values to a byte vector.
+ *
+ * Values are stored in native byte order, so buffers are only meant to be
+ * read back on machines with the same endianness.
+ */
+class ByteWriter {
+    std::vector<uint8_t>& out;
+public:
+    ByteWriter(std::vector<uint8_t>& out): out(out) {}
+
+    template<typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto bytes = reinterpret_cast<const uint8_t *>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    // LEB128, small values take a single byte
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+};
+
+/**
+ * @brief Reads back values written by ByteWriter, throwing if the buffer is too short.
+ */
+class ByteReader {
+    const uint8_t *data;
+    size_t size;
+    size_t position = 0;
+
+    void require(size_t length) const {
+        if (size - position < length)
+            throw std::out_of_range("not enough bytes left in buffer");
+    }
+public:
+    ByteReader(const uint8_t *data, size_t size): data(data), size(size) {}
+
+    template<typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <box2d/box2d.h>
+
+#include "player.hpp"
+#include "rocket.hpp"
+#include "explosion.hpp"
+#include "smallvector.hpp"
+
+class ContactListener: public b2ContactListener {
+    ExplosionSystem& explosions;
+
+    // explosions can't be created while the world is stepping, so they're
+    // collected here and created once the step is over
+    struct QueuedExplosion {
+        b2Vec2 location;
+    };
+    SmallVector<QueuedExplosion, 32> queuedExplosions;
+
+    void setupForExplosion(Rocket *rocket, b2Vec2 position);
+    void explosionReached(uint32_t slot, Entity *entity);
+public:
+    ContactListener(ExplosionSystem& explosions);
+
+    void BeginContact(b2Contact *contact);
+    void EndContact(b2Contact *contact);
+
+    /**
+     * @brief Finds what every explosion reaches, for ExplosionDetection::QUERIES.
+     *
+     * Players' nearby explosions must have been cleared beforehand, since
+     * nothing tells them when an explosion stops reaching them.
+     */
+    void queryExplosionOverlaps(b2World& world);
+
+    /**
+     * @brief Drops a player's nearby explosions that no longer reach it, for
+     * ExplosionDetection::SENSOR_BODIES. Only valid between steps.
+     *
+     * Contacts of newly created explosion bodies can only begin, so
+     * overlaps restored along with them that have ended since would never
+     * be removed otherwise.
+     */
+    void dropUnreachedExplosions(Player& player);
+
+    void flushQueuedExplosions();
+};
@@ -1,19 +1,27 @@
 #pragma once
 
 #include <box2d/box2d.h>
+#include <cstdint>
 #include <functional>
+#include <variant>
 
 // avoids double definition of vector types
 #include <raylib.h>
 #include <raymath.h>
 
+#include "rendercommands.hpp"
+
 class Entity {
 protected:
     std::reference_wrapper<b2World> world;
     b2Body *body;
     b2Fixture *fixture;
+    // position before the last world step, for render interpolation
+    b2Vec2 previousPosition;
 
     void swap(Entity& other);
+    // covers the body from its previous to its current position, grown by extent
+    b2AABB sweptBounds(float extent) const;
 
 public:
     enum EntityType {
@@ -25,10 +33,30 @@ public:
     };
     const EntityType type;
 
+    // everything about the body that changes while simulating
+    struct BodyState {
+        b2Vec2 position;
+        float angle;
+        b2Vec2 linearVelocity;
+        float angularVelocity;
+        bool enabled;
+        bool awake;
+        // explicit and zeroed, so equal states are equal bytes
+        uint8_t padding[2] = {};
+    };
+
+    // everything needed to create the body and its fixture again
+    struct Blueprint {
+        b2BodyDef body;
+        // without its shape pointer, which would dangle once copied
+        b2FixtureDef fixture;
+        std::variant<b2CircleShape, b2PolygonShape> shape;
+    };
+
     Entity(
         b2World& world,
         b2Body *body,
-        b2Shape *shape,
+        const b2Shape& shape,
         float fixtureDensity,
         EntityType type,
         int collisionMask
@@ -45,8 +73,21 @@ public:
     virtual void update(float deltaTime) = 0;
     b2Vec2 box2dPosition() const;
     Vector2 raylibPosition() const;
+    const b2Fixture *getFixture() const;
+
+    void savePreviousPosition();
+    // alpha: [0, 1], 0 being the previous step and 1 the current one
+    b2Vec2 interpolatedBox2dPosition(float alpha) const;
+    Vector2 interpolatedRaylibPosition(float alpha) const;
+
+    virtual void render(RenderCommandBuffer& commands, float alpha) const = 0;
+
+    BodyState saveBodyState() const;
+    void loadBodyState(const BodyState& state);
 
-    virtual void render() const = 0;
+    Blueprint saveBlueprint() const;
+    // for when the world was replaced, the old body is never destroyed
+    void rebuildBody(const Blueprint& blueprint);
 
     static b2BodyDef defaultBodyDef();
 
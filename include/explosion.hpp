@@ -1,15 +1,169 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 #include "entity.hpp"
+#include "bytebuffer.hpp"
 
+// Sensor body marking where an explosion hits, its state lives in ExplosionSystem
 class Explosion: public Entity {
-    float timeAliveRatio;
-    float animRadius;
+    uint32_t slot;
 
 public:
-    Explosion(b2World& world, b2Vec2 position);
-    void render() const;
+    Explosion(b2World& world, b2Vec2 position, uint32_t slot);
+    // explosions are updated and drawn in bulk by ExplosionSystem
+    void render(RenderCommandBuffer& commands, float alpha) const {}
+    void update(float deltaTime) {}
+    uint32_t getSlot() const;
+};
+
+// How explosions find out what is within their reach
+enum class ExplosionDetection: uint8_t {
+    // a Box2D sensor body per explosion, reported through the contact listener
+    SENSOR_BODIES,
+    // no bodies, the world is queried around every explosion once per tick
+    QUERIES,
+};
+
+/**
+ * @brief Every live explosion, stored as a structure of arrays.
+ *
+ * All explosions last the same time, so they end in the order they were
+ * spawned. They are kept in a ring buffer where live ones are always a
+ * contiguous range starting at the oldest, which keeps the per-tick update
+ * a straight loop over packed floats and lets expired explosions be
+ * dropped by moving the start of the range. An explosion keeps its slot in
+ * the ring for its whole life.
+ */
+class ExplosionSystem {
+    b2World& world;
+    const ExplosionDetection detection;
+    const uint32_t slotCount;
+    uint64_t first = 0;
+    uint64_t end = 0;
+    uint64_t dropped = 0;
+
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> timeAliveRatio;
+    std::vector<float> animRadius;
+    std::vector<float> strength;
+    std::vector<std::optional<Explosion>> bodies;
+
+    // explosions in view, gathered by render() to be converted in bulk
+    mutable std::vector<float> visibleX;
+    mutable std::vector<float> visibleY;
+    mutable std::vector<float> visibleRadius;
+    mutable std::vector<float> visibleTimeAlive;
+
+    void updateRange(uint32_t from, uint32_t to, float deltaRatio);
+public:
+    // how long every explosion lasts, in seconds
+    static constexpr float lifetime = 1.0f;
+    static constexpr float hitboxRadius = 3.0f;
+    static constexpr int collisionMask = Entity::EntityType::PLAYER | Entity::EntityType::ROCKET;
+
+    struct State {
+        b2Vec2 position;
+        float timeAliveRatio;
+        float animRadius;
+    };
+
+    /**
+     * @brief Construct a new ExplosionSystem object.
+     *
+     * @param capacity Maximum amount of explosions alive at the same time.
+     * Rounded up to a power of two.
+     * @param detection Whether explosions get sensor bodies, or have to be queried for overlaps.
+     */
+    ExplosionSystem(
+        b2World& world,
+        size_t capacity,
+        ExplosionDetection detection = ExplosionDetection::SENSOR_BODIES
+    );
+
+    ExplosionSystem(const ExplosionSystem&) = delete;
+    ExplosionSystem& operator=(const ExplosionSystem&) = delete;
+
+    /**
+     * @brief Creates an explosion. Must not be called while the world is stepping.
+     *
+     * @return true If it was created, false if every slot is taken, which
+     * is counted by droppedCount().
+     */
+    bool spawn(b2Vec2 position);
+
+    /**
+     * @brief Advances every explosion and removes the ones that are over.
+     */
     void update(float deltaTime);
-    bool isOver() const;
-    float calculateStrength() const;
+
+    /**
+     * @brief Records the explosions overlapping a view, or all of them if view is nullptr.
+     */
+    void render(RenderCommandBuffer& commands, const b2AABB *view = nullptr) const;
+
+    /**
+     * @brief Removes every explosion.
+     */
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const;
+    ExplosionDetection getDetection() const;
+
+    /**
+     * @brief Explosions spawn() had no slot for since construction, zero
+     * as long as the capacity covers the worst case.
+     */
+    uint64_t droppedCount() const;
+
+    /**
+     * @brief Calls a function with the slot of every live explosion, oldest first.
+     */
+    template<typename F>
+    void forEachSlot(F&& function) const {
+        for (uint64_t i = first; i < end; i++)
+            function(static_cast<uint32_t>(i % slotCount));
+    }
+
+    /**
+     * @brief Calls a function with the sensor body of every live explosion,
+     * oldest first, if they have one.
+     */
+    template<typename F>
+    void forEachBody(F&& function) {
+        for (uint64_t i = first; i < end; i++) {
+            std::optional<Explosion>& body = bodies[i % slotCount];
+            if (body)
+                function(*body);
+        }
+    }
+
+    b2Vec2 positionAt(uint32_t slot) const;
+    float strengthAt(uint32_t slot) const;
+
+    void saveState(ByteWriter& writer) const;
+    void loadState(ByteReader& reader);
+
+    /**
+     * @brief Bytes written by saveSnapshot(), fixed for a given capacity.
+     */
+    size_t snapshotSize() const;
+
+    /**
+     * @brief Copies every array as is, slots included, to snapshotSize() bytes at out.
+     */
+    void saveSnapshot(uint8_t *out) const;
+
+    /**
+     * @brief Restores what saveSnapshot() wrote, with new sensor bodies for
+     * every live slot, so their contacts begin again on the next step.
+     *
+     * The old bodies end their contacts when they're destroyed, whatever
+     * the contact listener keeps track of must be restored afterwards.
+     */
+    void loadSnapshot(const uint8_t *in);
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "world.hpp"
+
+/**
+ * @brief Converts variable frame times into a whole number of fixed simulation steps.
+ */
+class FixedTimestep {
+    const float interval;
+    const int maxSteps;
+    float accumulator = 0;
+public:
+    /**
+     * @brief Construct a new FixedTimestep object.
+     *
+     * @param interval Length of a single simulation step.
+     * @param maxStepsPerFrame Upper bound on the steps returned by advance(). Time beyond
+     * this is dropped, so a slow frame can't make the next one even slower.
+     */
+    FixedTimestep(
+        float interval = SIMULATION_STEP_INTERVAL,
+        int maxStepsPerFrame = SIMULATION_MAX_STEPS_PER_FRAME
+    );
+
+    /**
+     * @brief Accumulates frame time and consumes it in whole steps.
+     *
+     * @param frameTime Time elapsed since the last call.
+     * @return int How many simulation steps should run this frame.
+     */
+    int advance(float frameTime);
+
+    /**
+     * @brief How far the leftover time is into the next step.
+     * @return [0, 1) range, used to interpolate between the last two simulated states.
+     */
+    float alpha() const;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr uint64_t FNV1A_OFFSET_BASIS = 0xcbf29ce484222325;
+constexpr uint64_t FNV1A_PRIME = 0x100000001b3;
+
+/**
+ * @brief 64 bit FNV-1a hash, for telling apart buffers, not for security.
+ *
+ * @param hash Result of hashing the preceding bytes, to hash a buffer in parts.
+ */
+inline uint64_t fnv1a(const void *data, size_t size, uint64_t hash = FNV1A_OFFSET_BASIS) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "simulation.hpp"
+#include "transport.hpp"
+
+/**
+ * @brief Deterministic stand-in for the mouse, so headless runs exercise rockets,
+ * explosions and recoil without a window.
+ *
+ * @param tick The tick the input will be applied before.
+ */
+TickInput scriptedInput(uint64_t tick);
+
+/**
+ * @brief Steps a fresh Simulation as fast as possible and reports ticks per second.
+ *
+ * @param ticks How many simulation steps to run.
+ * @param recordPath If not empty, the run is also recorded as a replay to this file.
+ * @param options How the simulation plays out.
+ * @return int Process exit code.
+ */
+int runHeadless(uint64_t ticks, std::string_view recordPath = "", SimulationOptions options = {});
+
+/**
+ * @brief Steps many independent simulations concurrently and reports the
+ * combined ticks per second.
+ *
+ * @param worldCount How many simulations to run.
+ * @param ticks How many steps each of them runs.
+ * @param options Options every simulation is created with.
+ * @return int Process exit code.
+ */
+int runBatch(size_t worldCount, uint64_t ticks, SimulationOptions options = {});
+
+/**
+ * @brief Plays a two player rollback match between two peers in this
+ * process, over a LoopbackLink, and reports how much was resimulated.
+ *
+ * @param ticks How many ticks both peers have to reach.
+ * @param network Simulated latency, jitter and loss between them.
+ * @param options Options both simulations are created with.
+ * @return int Process exit code, 1 if the peers desynced.
+ */
+int runRollback(uint64_t ticks, LoopbackOptions network, SimulationOptions options = {});
+
+/**
+ * @brief Plays a scripted match on a level, recording a frame of render
+ * commands after every step, with and without culling and cached wall
+ * layers, and reports what was recorded. Nothing is drawn, so no window is needed.
+ *
+ * @param level Level to play on.
+ * @param frames How many frames to record each way.
+ * @param view Area of the world culled frames are limited to, in meters.
+ * @param options How the simulation plays out.
+ * @return int Process exit code.
+ */
+int runRenderStats(const Level& level, int frames, const b2AABB& view, SimulationOptions options = {});
+
+/**
+ * @brief Plays a replay back without a window as fast as possible and reports ticks per second.
+ *
+ * @param path Replay file to play.
+ * @param fromTick Tick to seek to before starting the clock.
+ * @return int Process exit code.
+ */
+int runReplay(std::string_view path, uint64_t fromTick = 0);
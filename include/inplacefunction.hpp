@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename Signature, size_t Capacity = 2 * sizeof(void *)>
+class InplaceFunction;
+
+/**
+ * @brief Callable wrapper like std::function, that stores its target inline.
+ *
+ * Only trivially copyable callables that fit in Capacity bytes are accepted,
+ * like function pointers and lambdas capturing `this` or a few values, so
+ * construction never allocates and copies are plain memcpys.
+ *
+ * @tparam R Return type of the callable.
+ * @tparam Args Argument types of the callable.
+ * @tparam Capacity Bytes of inline storage.
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    R (*invoker)(const void *, Args...) = nullptr;
+
+    template<typename F>
+    static R invoke(const void *target, Args... args) {
+        return (*std::launder(static_cast<const F *>(target)))(std::forward<Args>(args)...);
+    }
+public:
+    /**
+     * @brief Construct an empty InplaceFunction. Calling it is undefined.
+     */
+    InplaceFunction() = default;
+
+    /**
+     * @brief Construct an InplaceFunction holding a copy of a callable.
+     *
+     * @param function Callable to store, checked at compile time to fit inline.
+     */
+    template<typename F>
+        requires (!std::is_same_v<std::decay_t<F>, InplaceFunction>)
+            && std::is_invocable_r_v<R, const std::decay_t<F>&, Args...>
+    InplaceFunction(F&& function) {
+        using Target = std::decay_t<F>;
+        static_assert(sizeof(Target) <= Capacity, "callable too big for the inline storage");
+        static_assert(alignof(Target) <= alignof(std::max_align_t), "callable is overaligned");
+        static_assert(
+            std::is_trivially_copyable_v<Target> && std::is_trivially_destructible_v<Target>,
+            "callable must be trivially copyable, it is copied as raw bytes"
+        );
+        ::new (static_cast<void *>(storage)) Target(std::forward<F>(function));
+        invoker = &InplaceFunction::invoke<Target>;
+    }
+
+    R operator()(Args... args) const {
+        return invoker(storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const {
+        return invoker != nullptr;
+    }
+};
@@ -4,7 +4,7 @@
  *
  * The core object provided by the library is json11::Json. A Json object represents any JSON
  * value: null, bool, number (int or double), string (std::string), array (std::vector), or
- * object (std::map).
+ * object (JsonMap, a sorted std::vector with the interface of a std::map).
  *
  * Json objects act like values: they can be assigned, copied, moved, compared for equality or
  * order, etc. There are also helper methods Json::dump, to serialize a Json to a string, and
@@ -13,6 +13,10 @@
  * Internally, the various types of Json object are represented by the JsonValue class
  * hierarchy.
  *
+ * For large inputs, JsonDocument::parse builds the same tree inside a single arena instead,
+ * one compact JsonNode per value rather than one shared allocation each, and JsonView reads
+ * it with the same accessors as Json.
+ *
  * A note on numbers - JSON specifies the syntax of number formatting but not its semantics,
  * so some JSON implementations distinguish between integers and floating-point numbers, while
  * some don't. In json11, we choose the latter. Because some JSON implementations (namely
@@ -50,9 +54,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <utility>
 #include <memory>
 #include <initializer_list>
 
@@ -75,6 +82,77 @@ enum JsonParse {
 };
 
 class JsonValue;
+class Json;
+
+/* JsonMap
+ *
+ * The members of a JSON object, as a vector sorted by key: lookups are binary searches over
+ * contiguous memory rather than tree walks, and the members are a single allocation rather
+ * than one each. It has the parts of std::map's interface that Json objects are used with,
+ * iterating in the same order, so code written for a std::map keeps working. Inserting moves
+ * the members after the new one, so large objects are best built whole, from a list or a
+ * range, as parsing does.
+ */
+class JsonMap final {
+public:
+    typedef std::string key_type;
+    typedef Json mapped_type;
+    typedef std::pair<std::string, Json> value_type;
+    typedef std::vector<value_type>::iterator iterator;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+    typedef std::vector<value_type>::size_type size_type;
+
+    JsonMap() noexcept;
+    // Like std::map, only the first of repeated keys is kept.
+    JsonMap(std::initializer_list<value_type> members);
+    template <class It>
+    JsonMap(It first, It last);
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    void clear() noexcept;
+    void reserve(size_type count);
+
+    // Return the value for key, inserting a null one if there is none.
+    Json &operator[](const std::string &key);
+    Json &operator[](std::string &&key);
+    // Return the value for key, throwing std::out_of_range if there is none.
+    Json &at(std::string_view key);
+    const Json &at(std::string_view key) const;
+
+    iterator find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+    size_type count(std::string_view key) const;
+    bool contains(std::string_view key) const;
+    iterator lower_bound(std::string_view key);
+    const_iterator lower_bound(std::string_view key) const;
+
+    // Insert unless the key is already there. Return where the key is, and whether it was
+    // inserted.
+    std::pair<iterator, bool> insert(const value_type &member);
+    std::pair<iterator, bool> insert(value_type &&member);
+    std::pair<iterator, bool> emplace(std::string key, Json value);
+
+    size_type erase(std::string_view key);
+    iterator erase(const_iterator pos);
+
+    bool operator== (const JsonMap &rhs) const;
+    bool operator<  (const JsonMap &rhs) const;
+    bool operator!= (const JsonMap &rhs) const { return !(*this == rhs); }
+
+private:
+    // Sort the members and drop all but the first of repeated keys.
+    void sort_members();
+
+    std::vector<value_type> m_members;
+};
 
 class Json final {
 public:
@@ -85,7 +163,7 @@ public:
 
     // Array and object typedefs
     typedef std::vector<Json> array;
-    typedef std::map<std::string, Json> object;
+    typedef JsonMap object;
 
     // Constructors for the various types of JSON value.
     Json() noexcept;                // NUL
@@ -144,7 +222,7 @@ public:
     const std::string &string_value() const;
     // Return the enclosed std::vector if this is an array, or an empty vector otherwise.
     const array &array_items() const;
-    // Return the enclosed std::map if this is an object, or an empty map otherwise.
+    // Return the enclosed JsonMap if this is an object, or an empty map otherwise.
     const object &object_items() const;
 
     // Return a reference to arr[i] if this is an array, Json() otherwise.
@@ -161,14 +239,19 @@ public:
     }
 
     // Parse. If parse fails, return Json() and assign an error message to err.
-    static Json parse(const std::string & in,
+    static Json parse(std::string_view in,
                       std::string & err,
                       JsonParse strategy = JsonParse::STANDARD);
+    static Json parse(const std::string & in,
+                      std::string & err,
+                      JsonParse strategy = JsonParse::STANDARD) {
+        return parse(std::string_view(in), err, strategy);
+    }
     static Json parse(const char * in,
                       std::string & err,
                       JsonParse strategy = JsonParse::STANDARD) {
         if (in) {
-            return parse(std::string(in), err, strategy);
+            return parse(std::string_view(in), err, strategy);
         } else {
             err = "null input";
             return nullptr;
@@ -176,13 +259,13 @@ public:
     }
     // Parse multiple objects, concatenated or separated by whitespace
     static std::vector<Json> parse_multi(
-        const std::string & in,
+        std::string_view in,
         std::string::size_type & parser_stop_pos,
         std::string & err,
         JsonParse strategy = JsonParse::STANDARD);
 
     static inline std::vector<Json> parse_multi(
-        const std::string & in,
+        std::string_view in,
         std::string & err,
         JsonParse strategy = JsonParse::STANDARD) {
         std::string::size_type parser_stop_pos;
@@ -208,6 +291,11 @@ private:
     std::shared_ptr<JsonValue> m_ptr;
 };
 
+template <class It>
+JsonMap::JsonMap(It first, It last) : m_members(first, last) {
+    sort_members();
+}
+
 // Internal class hierarchy - JsonValue objects are not exposed to users of this API.
 class JsonValue {
 protected:
@@ -229,4 +317,171 @@ protected:
     virtual ~JsonValue() {}
 };
 
+// Internal node of a JsonDocument - JsonNode objects are not exposed to users of this API.
+// Array items and object members are stored contiguously, before the node that holds them,
+// objects as alternating key and value nodes.
+struct JsonNode final {
+    uint8_t type;       // Json::Type
+    bool bool_value;    // BOOL
+    bool in_input;      // STRING: whether chars point into the parsed input
+    uint32_t length;    // STRING bytes, ARRAY items or OBJECT members
+    union {
+        double number;      // NUMBER
+        const char *chars;  // STRING
+        size_t offset;      // STRING while parsing: where the bytes start in the arena
+        size_t children;    // ARRAY, OBJECT: how many nodes back the first child is
+    };
+};
+
+/* JsonView
+ *
+ * A value inside a JsonDocument, read with the same accessors as Json. Views are cheap to
+ * copy and stay valid as long as the document they came from, even if it is moved.
+ */
+class JsonView final {
+public:
+    JsonView() noexcept : m_node(nullptr) {}  // NUL
+
+    Json::Type type() const;
+
+    bool is_null()   const { return type() == Json::NUL; }
+    bool is_number() const { return type() == Json::NUMBER; }
+    bool is_bool()   const { return type() == Json::BOOL; }
+    bool is_string() const { return type() == Json::STRING; }
+    bool is_array()  const { return type() == Json::ARRAY; }
+    bool is_object() const { return type() == Json::OBJECT; }
+
+    // Return the enclosed value if this is a number, 0 otherwise.
+    double number_value() const;
+    int int_value() const;
+
+    // Return the enclosed value if this is a boolean, false otherwise.
+    bool bool_value() const;
+    // Return the enclosed string if this is a string, "" otherwise.
+    std::string_view string_value() const;
+
+    // Return the number of items if this is an array or object, 0 otherwise.
+    size_t size() const;
+
+    // Return arr[i] if this is an array, JsonView() otherwise.
+    JsonView operator[](size_t i) const;
+    // Return obj[key] if this is an object, JsonView() otherwise. Like Json, the last
+    // of repeated keys wins.
+    JsonView operator[](std::string_view key) const;
+
+    // Return the key and the value of the i-th member if this is an object, "" and
+    // JsonView() otherwise. Members are in the order they were parsed, not sorted.
+    std::string_view key(size_t i) const;
+    JsonView value(size_t i) const;
+
+    // Copy into a Json, which also makes JsonView implicitly convertible to one.
+    Json to_json() const;
+
+private:
+    friend class JsonDocument;
+    explicit JsonView(const JsonNode *node) : m_node(node) {}
+
+    const JsonNode *m_node;
+};
+
+/* JsonDocument
+ *
+ * A parsed JSON value held in a single arena: one vector of nodes and one of string bytes,
+ * freed together with the document. Parsing allocates a few growing buffers instead of one
+ * shared JsonValue per value, and reading never counts references.
+ *
+ * Strings without escapes aren't copied at all but point into the parsed input, so the input
+ * (a std::string, a mapped file...) must outlive the document.
+ */
+class JsonDocument final {
+public:
+    JsonDocument() = default;  // NUL
+
+    // The parsed value, JsonView() if the document is empty.
+    JsonView root() const;
+
+    // Bytes held by the arena, to compare with what a Json tree would need.
+    size_t arena_size() const;
+
+    // Parse. If parse fails, return an empty document and assign an error message to err.
+    static JsonDocument parse(std::string_view in,
+                              std::string & err,
+                              JsonParse strategy = JsonParse::STANDARD);
+
+private:
+    std::vector<JsonNode> m_nodes;
+    std::vector<char> m_strings;
+};
+
+/* JsonHandler
+ *
+ * Receives what a JsonEventParser reads, in the order it appears: arrays and objects as a
+ * start and an end around their contents, with a key() before each value in an object.
+ * Strings are only valid during the call. Every event does nothing unless overridden.
+ */
+class JsonHandler {
+public:
+    virtual ~JsonHandler() {}
+    virtual void null_value() {}
+    virtual void bool_value(bool) {}
+    virtual void number_value(double) {}
+    virtual void string_value(std::string_view) {}
+    virtual void start_array() {}
+    virtual void end_array() {}
+    virtual void start_object() {}
+    virtual void key(std::string_view) {}
+    virtual void end_object() {}
+};
+
+/* JsonEventParser
+ *
+ * Parses JSON a chunk at a time, with the same grammar and errors as Json::parse, and calls a
+ * JsonHandler for each value as soon as it has been read instead of building anything. The
+ * only input kept between chunks is whatever the last one ended in the middle of (a string,
+ * number, literal or comment), so memory doesn't grow with the size of the input.
+ */
+class JsonEventParser final {
+public:
+    JsonEventParser(JsonHandler &handler,
+                    std::string &err,
+                    JsonParse strategy = JsonParse::STANDARD);
+
+    // Parse the next chunk of input. If the input so far is invalid, return false and assign
+    // an error message to err, and every later call returns false too.
+    bool feed(std::string_view chunk);
+    // Parse the end of the input, which fails if it ends before a whole value was read.
+    bool finish();
+
+    // Parse a whole input, as one chunk.
+    static bool parse(std::string_view in,
+                      JsonHandler &handler,
+                      std::string &err,
+                      JsonParse strategy = JsonParse::STANDARD);
+
+private:
+    struct Reader;
+
+    // What is expected next
+    enum State {
+        VALUE, FIRST_ITEM, NEXT_ITEM, AFTER_ITEM, FIRST_KEY, NEXT_KEY, COLON, AFTER_MEMBER,
+        TRAILING
+    };
+
+    JsonHandler &m_handler;
+    std::string &m_err;
+    const JsonParse m_strategy;
+    State m_state;
+    bool m_failed;
+    // '[' or '{' for every array or object started and not yet ended
+    std::vector<char> m_containers;
+    // the part of the last chunk that couldn't be parsed without the next
+    std::string m_pending;
+    // m_pending followed by the next chunk
+    std::string m_input;
+    // strings with escapes, decoded
+    std::string m_decoded;
+
+    bool run(std::string_view input, bool final);
+};
+
 } // namespace json11
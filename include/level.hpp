@@ -0,0 +1,143 @@
+#pragma once
+
+#include <box2d/box2d.h>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mappedfile.hpp"
+
+/*
+ * Levels are authored as JSON:
+ *
+ *   {
+ *       "walls": [
+ *           {"position": [-10, 10], "size": [20, 5]}
+ *       ]
+ *   }
+ *
+ * with positions being the top left corner of each wall and sizes its
+ * width and height, all in meters.
+ *
+ * The first load of a level cooks it into a binary file next to it, at
+ * <path>.cooked, which later loads map instead of parsing the JSON:
+ *
+ *   header: "RJLV", u16 version, u16 zero, u32 wall count, u32 chunk count,
+ *           u64 FNV-1a of the JSON source, u64 FNV-1a of everything after the header,
+ *           f32 chunk size, u32 zero
+ *   chunks: chunk count * LevelChunk
+ *   walls:  wall count * (f32 x, f32 y, f32 width, f32 height), grouped by chunk
+ *
+ * all in native byte order. A cooked file whose source hash doesn't match
+ * the JSON next to it is stale, and is cooked again.
+ *
+ * Walls belong to the square chunk their center falls in, so a level can
+ * be streamed in around the players a chunk at a time, see LevelStreamer.
+ */
+
+struct WallDefinition {
+    b2Vec2 position;
+    b2Vec2 dimensions;
+};
+
+/**
+ * @brief Static terrain for a Simulation to be built with.
+ */
+struct Level {
+    std::vector<WallDefinition> walls;
+
+    /**
+     * @brief The ground under the spawn, used when no level is given.
+     */
+    static const Level& builtin();
+
+    /**
+     * @brief FNV-1a of every wall, in order, which is all a Simulation is built from.
+     */
+    uint64_t hash() const;
+};
+
+/**
+ * @brief Parses a level from its JSON source.
+ *
+ * @throws std::runtime_error If the JSON is malformed or isn't a level.
+ */
+Level parseLevel(std::string_view json);
+
+/**
+ * @brief Loads a JSON level, from its cooked cache when it's up to date.
+ *
+ * Cooks the level when the cache is missing or stale. Failing to write
+ * the cache, e.g. to a read-only directory, isn't an error.
+ *
+ * @throws std::runtime_error If the file can't be read or isn't a level.
+ */
+Level loadLevel(std::string_view path);
+
+/**
+ * @brief Reads a cooked level, if it's valid and was cooked from a source with this hash.
+ */
+std::optional<Level> readCookedLevel(std::string_view cookedPath, uint64_t sourceHash);
+
+/**
+ * @brief Writes a cooked level, replacing any previous one at once.
+ *
+ * @return false If the file couldn't be written.
+ */
+bool writeCookedLevel(std::string_view cookedPath, const Level& level, uint64_t sourceHash);
+
+/**
+ * @brief Walls of a level whose centers fall in the same square, as stored in cooked levels.
+ */
+struct LevelChunk {
+    // in chunks, the square spans [x, x + 1) * chunk size
+    int32_t x;
+    int32_t y;
+    uint32_t firstWall;
+    uint32_t wallCount;
+    // bounds of every wall in the chunk, which may stick out of its square
+    b2Vec2 lowerBound;
+    b2Vec2 upperBound;
+};
+
+/**
+ * @brief A cooked level, mapped in place so chunks can be read one at a time.
+ */
+class ChunkedLevel {
+    // unset when the cache couldn't be written, the cooked bytes are kept in memory then
+    std::optional<MappedFile> file;
+    std::vector<uint8_t> cookedInMemory;
+    float chunkSize;
+    // copied out, it's small and looked up often
+    std::vector<LevelChunk> chunks;
+    const uint8_t *walls;
+
+    void useCooked(const uint8_t *data);
+public:
+    /**
+     * @brief Opens a JSON level through its cooked cache, cooking it first if it's missing or stale.
+     *
+     * @throws std::runtime_error If the file can't be read or isn't a level.
+     */
+    explicit ChunkedLevel(std::string_view path);
+
+    ChunkedLevel(ChunkedLevel&&) = default;
+    ChunkedLevel& operator=(ChunkedLevel&&) = default;
+
+    float getChunkSize() const;
+
+    /**
+     * @brief Every chunk with at least one wall.
+     */
+    std::span<const LevelChunk> getChunks() const;
+
+    /**
+     * @brief Copies the walls of a chunk, reading them from disk if they aren't cached.
+     *
+     * Safe to call from any thread.
+     */
+    void readWalls(const LevelChunk& chunk, std::vector<WallDefinition>& out) const;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <box2d/box2d.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "level.hpp"
+#include "wall.hpp"
+#include "walllayer.hpp"
+
+struct LevelStreamingOptions {
+    // chunks with walls within this distance of a player's chunk are loaded
+    float loadDistance = 32.0f;
+    // and kept until they're further than this, so going back and forth
+    // over a chunk border doesn't reload them
+    float unloadDistance = 64.0f;
+    // most wall bodies created per update, spreading big chunks over several steps
+    size_t wallsPerUpdate = 256;
+};
+
+/**
+ * @brief Keeps the walls of a ChunkedLevel in the world only around a set of points.
+ *
+ * Chunks coming into range are read on a background thread, so touching
+ * the disk never stalls a step. Box2D isn't thread safe, so their bodies
+ * are created by update(), between steps, a few at a time. Chunks out of
+ * range have their bodies destroyed, so memory and broadphase size follow
+ * the area around the points, not the size of the level.
+ */
+class LevelStreamer {
+    struct StreamedChunk {
+        // filled in by the loader, emptied as bodies are created
+        std::vector<WallDefinition> definitions;
+        bool read = false;
+        size_t created = 0;
+        // deque so walls never move, fixtures point to them
+        std::deque<Wall> walls;
+        // a cache, filled in by render()
+        mutable WallLayer layer;
+    };
+
+    struct ReadChunk {
+        uint32_t chunkIndex;
+        std::vector<WallDefinition> definitions;
+    };
+
+    b2World& world;
+    const ChunkedLevel level;
+    const LevelStreamingOptions options;
+
+    // by index into level.getChunks(), every chunk in range or on its way in
+    std::unordered_map<uint32_t, StreamedChunk> chunks;
+    // read chunks waiting for bodies, oldest first
+    std::deque<uint32_t> creating;
+    std::vector<std::pair<int32_t, int32_t>> focusCells;
+    std::vector<std::pair<int32_t, int32_t>> scratchCells;
+    std::vector<ReadChunk> received;
+    size_t bodyCount = 0;
+
+    // shared with the loader thread
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable readDone;
+    std::deque<uint32_t> requests;
+    std::vector<ReadChunk> ready;
+    size_t pendingReads = 0;
+    bool stopping = false;
+    // last, so it starts once everything it uses is constructed
+    std::thread loader;
+
+    void loaderLoop();
+    void refreshChunksInRange();
+    void takeReadChunks();
+    void createWalls(size_t budget);
+    void unload(uint32_t chunkIndex);
+public:
+    LevelStreamer(b2World& world, ChunkedLevel level, LevelStreamingOptions options = {});
+    ~LevelStreamer();
+
+    LevelStreamer(const LevelStreamer&) = delete;
+    LevelStreamer& operator=(const LevelStreamer&) = delete;
+
+    /**
+     * @brief Requests and drops chunks around the points, and creates some
+     * of the walls read since the last call. Only between steps.
+     */
+    void update(std::span<const b2Vec2> focus);
+
+    /**
+     * @brief Waits for every requested chunk to be read and creates all of their walls.
+     */
+    void finishLoading();
+
+    /**
+     * @brief Records the walls of loaded chunks overlapping a view, in
+     * pixels, or all of them if view is nullptr.
+     */
+    void render(RenderCommandBuffer& commands, const Rectangle *view = nullptr) const;
+
+    /**
+     * @brief Calls a function with every wall that has a body.
+     */
+    template<typename F>
+    void forEachWall(F&& function) {
+        for (auto& [chunkIndex, chunk]: chunks) {
+            for (Wall& wall: chunk.walls)
+                function(wall);
+        }
+    }
+
+    size_t loadedChunkCount() const;
+    size_t wallCount() const;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Read-only view of a whole file, mapped into memory.
+ *
+ * Pages are read from disk as they are touched, so nothing is copied up
+ * front, and the OS can share them between processes.
+ */
+class MappedFile {
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void *mapping = nullptr;
+#endif
+
+    void unmap();
+public:
+    /**
+     * @brief Maps a file.
+     *
+     * @throws std::runtime_error If the file can't be opened or mapped.
+     */
+    explicit MappedFile(std::string_view path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t *data() const;
+    size_t size() const;
+};
@@ -7,7 +7,10 @@
 #include "entity.hpp"
 #include "rocket.hpp"
 #include "timer.hpp"
+#include "timerwheel.hpp"
 #include "recoilwave.hpp"
+#include "pool.hpp"
+#include "sparseset.hpp"
 
 class Player: public Entity {
 private:
@@ -17,8 +20,12 @@ private:
 
     bool chargingRecoil = false;
     int rocketAmmo = Player::maxRockets;
+    // explosion slots whose hitbox overlaps this player
+    SparseSet nearbyExplosions;
 
     void updateTimers(float deltaTime);
+    // pauses the timers that only run in some states
+    void updateTimersRunning();
     void doRocketReload();
 public:
     static constexpr int maxRockets = 3;
@@ -26,17 +33,36 @@ public:
 
     static_assert(Player::rocketReloadTime > Rocket::lifetime);
 
+    struct State {
+        BodyState body;
+        Timer::State rocketReload;
+        Timer::State recoilReload;
+        Timer::State recoilCharge;
+        int rocketAmmo;
+        bool chargingRecoil;
+        uint8_t padding[3] = {};
+    };
+
     // TODO draw rocket count UI in a fixed position on the screen
     // TODO fix long interactions between player and explosions
 
-    Player(b2World& world, b2Vec2 position);
+    // explosionCapacity: amount of slots explosions are spawned in
+    // timerWheel: drives the timers instead of update() if not nullptr
+    Player(b2World& world, b2Vec2 position, size_t explosionCapacity, TimerWheel *timerWheel = nullptr);
     void update(float deltaTime);
-    void render() const;
+    void render(RenderCommandBuffer& commands, float alpha) const;
+    // in meters, covers whatever render() draws at any alpha
+    b2AABB renderBounds() const;
     int getRocketAmmo() const;
     float getRocketReload() const;
     float getRecoilReload() const;
-    Rocket *shootRocketTowards(b2Vec2 target);
+    // returns nullptr if out of ammo or if the pool is full
+    Rocket *shootRocketTowards(b2Vec2 target, Pool<Rocket>& rocketPool);
     bool startChargingRecoil();
     void recoilFrom(b2Vec2 origin, RecoilWave& recoilWave);
-    void feelExplosion(const Explosion& explosion);
+    void feelExplosion(b2Vec2 origin, float strength);
+    SparseSet& getNearbyExplosions();
+    const SparseSet& getNearbyExplosions() const;
+    State saveState() const;
+    void loadState(const State& state);
 };
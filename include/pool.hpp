@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed-capacity storage for objects of a single type.
+ *
+ * All memory is allocated once at construction, in one contiguous block,
+ * so creating and destroying objects never touches the heap. Objects never
+ * move, so pointers to them stay valid until they are destroyed, and each
+ * one keeps the same slot index during its whole life.
+ */
+template<typename T>
+class Pool {
+    struct Slot {
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    const size_t slotCount;
+    std::unique_ptr<Slot[]> slots;
+    std::vector<bool> live;
+    std::vector<uint32_t> freeSlots;
+
+    T *slotPointer(size_t index) {
+        return std::launder(reinterpret_cast<T *>(slots[index].storage));
+    }
+public:
+    /**
+     * @brief Construct a new Pool object.
+     *
+     * @param capacity Maximum amount of objects alive at the same time.
+     */
+    explicit Pool(size_t capacity):
+        slotCount(capacity),
+        slots(new Slot[capacity]),
+        live(capacity, false)
+    {
+        freeSlots.reserve(capacity);
+        // reversed so the lowest slots get used first
+        for (size_t i = capacity; i > 0; i--)
+            freeSlots.push_back(i - 1);
+    }
+
+    ~Pool() {
+        for (size_t i = 0; i < slotCount; i++) {
+            if (live[i])
+                slotPointer(i)->~T();
+        }
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /**
+     * @brief Constructs an object in a free slot.
+     *
+     * @return T* The new object, or nullptr if every slot is taken.
+     */
+    template<typename... Args>
+    T *create(Args&&... args) {
+        if (freeSlots.empty())
+            return nullptr;
+        uint32_t index = freeSlots.back();
+        T *object = new (slots[index].storage) T(std::forward<Args>(args)...);
+        freeSlots.pop_back();
+        live[index] = true;
+        return object;
+    }
+
+    /**
+     * @brief Destroys an object created by this pool and frees its slot. Accepts nullptr.
+     */
+    void destroy(T *object) {
+        if (object == nullptr) return;
+        size_t index = indexOf(object);
+        object->~T();
+        live[index] = false;
+        freeSlots.push_back(index);
+    }
+
+    /**
+     * @brief Slot of an object created by this pool, in the [0, capacity) range.
+     */
+    size_t indexOf(const T *object) const {
+        auto slot = reinterpret_cast<const Slot *>(object);
+        return static_cast<size_t>(slot - slots.get());
+    }
+
+    /**
+     * @brief Object living in the given slot, or nullptr if the slot is free.
+     */
+    T *at(size_t index) {
+        return live.at(index) ? slotPointer(index) : nullptr;
+    }
+
+    size_t capacity() const {
+        return slotCount;
+    }
+
+    size_t size() const {
+        return slotCount - freeSlots.size();
+    }
+};
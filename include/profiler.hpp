@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+ * Scoped hot path instrumentation, only compiled in when RJ_PROFILE is
+ * defined (`make PROFILE=1`). Otherwise RJ_PROFILE_SCOPE expands to nothing.
+ *
+ * Every thread records into its own fixed size ring buffer, so recording
+ * never locks or allocates; once full, the oldest events are overwritten.
+ */
+
+#ifdef RJ_PROFILE
+constexpr bool PROFILER_ENABLED = true;
+
+/**
+ * @brief Records the time between its construction and destruction as one event.
+ */
+class ProfileScope {
+    const char *name;
+    uint64_t begin;
+public:
+    /**
+     * @param name Must outlive the profiler, usually a string literal.
+     */
+    explicit ProfileScope(const char *name);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define RJ_PROFILE_JOIN_IMPL(a, b) a##b
+#define RJ_PROFILE_JOIN(a, b) RJ_PROFILE_JOIN_IMPL(a, b)
+#define RJ_PROFILE_SCOPE(name) ProfileScope RJ_PROFILE_JOIN(profileScope, __LINE__)(name)
+#else
+constexpr bool PROFILER_ENABLED = false;
+
+#define RJ_PROFILE_SCOPE(name)
+#endif
+
+/**
+ * @brief Writes the events still held by every thread's buffer as Chrome
+ * trace_event JSON, to be opened in chrome://tracing or Perfetto.
+ *
+ * Safe to call while other threads keep recording. Writes an empty trace
+ * when the profiler is compiled out.
+ */
+void writeChromeTrace(std::ostream& out);
+
+/**
+ * @brief One finished scope, as recorded by RJ_PROFILE_SCOPE.
+ */
+struct ProfileRecord {
+    const char *name;
+    // steady clock nanoseconds
+    uint64_t begin;
+    uint64_t end;
+    int threadIndex;
+};
+
+/**
+ * @brief Appends the events every thread recorded since the last drain.
+ *
+ * Independent from writeChromeTrace(), which always sees the whole buffers.
+ *
+ * @return uint64_t How many events were overwritten before they could be
+ * drained. Drain more often if not 0.
+ */
+uint64_t drainProfileRecords(std::vector<ProfileRecord>& out);
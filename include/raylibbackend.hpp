@@ -0,0 +1,44 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "rendercommands.hpp"
+#include "walllayer.hpp"
+
+/**
+ * @brief Draws recorded commands with raylib, and owns the GPU side of
+ * cached wall layers, so it has to live on the thread that draws.
+ *
+ * Wall textures are made the first time their outlines are drawn, and
+ * unloaded after a frame that didn't draw them. Must be destroyed before
+ * the window is closed.
+ */
+class RaylibBackend {
+    struct LayerTexture {
+        // also keeps the outlines' address from being reused by other outlines
+        std::shared_ptr<const WallOutlines> outlines;
+        RenderTexture2D texture;
+        uint64_t lastDrawnFrame;
+    };
+
+    std::unordered_map<const WallOutlines *, LayerTexture> layerTextures;
+    uint64_t frame = 0;
+
+    void drawCommands(const RenderCommandBuffer& commands);
+    void drawCachedLayer(const std::shared_ptr<const WallOutlines>& outlines);
+public:
+    RaylibBackend() = default;
+    ~RaylibBackend();
+
+    RaylibBackend(const RaylibBackend&) = delete;
+    RaylibBackend& operator=(const RaylibBackend&) = delete;
+
+    /**
+     * @brief Draws the commands in the order they are in, usually after
+     * sorting them. Must be called between BeginMode2D and EndMode2D.
+     */
+    void draw(const RenderCommandBuffer& commands);
+};
@@ -2,6 +2,7 @@
 
 #include "entity.hpp"
 #include "timer.hpp"
+#include "timerwheel.hpp"
 
 class RecoilWave: public Entity {
     Timer duration;
@@ -9,8 +10,18 @@ class RecoilWave: public Entity {
 public:
     static constexpr float lifetime = 1.0f;
 
-    RecoilWave(b2World& world);
+    struct State {
+        BodyState body;
+        Timer::State duration;
+    };
+
+    // timerWheel: drives the duration instead of update() if not nullptr
+    RecoilWave(b2World& world, TimerWheel *timerWheel = nullptr);
     void update(float deltaTime);
-    void render() const;
+    void render(RenderCommandBuffer& commands, float alpha) const;
+    // in meters, covers whatever render() draws at any alpha
+    b2AABB renderBounds() const;
     void moveTo(b2Vec2 position, b2Vec2 direction);
+    State saveState() const;
+    void loadState(const State& state);
 };
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+struct WallOutlines;
+
+// What gets drawn over what, lower layers first
+enum class RenderLayer: uint8_t {
+    EXPLOSIONS,
+    ROCKETS,
+    // before players, so they hide their recoil wave spawning in
+    RECOIL_WAVES,
+    PLAYERS,
+    WALLS,
+};
+
+constexpr size_t renderLayerCount = 5;
+
+/**
+ * @brief One recorded draw, in raylib coordinates.
+ */
+struct RenderCommand {
+    enum class Type: uint8_t {
+        CIRCLE,
+        CIRCLE_SECTOR,
+        CIRCLE_LINES,
+        CIRCLE_SECTOR_LINES,
+        TRIANGLE_LINES,
+        RECTANGLE_LINES,
+        LINE,
+        // a WallLayer's outlines, drawn from a texture
+        CACHED_LAYER,
+    };
+    static constexpr size_t typeCount = 8;
+
+    struct Circle {
+        Vector2 center;
+        float radius;
+        // in degrees, sectors only
+        float startAngle;
+        float endAngle;
+    };
+
+    struct Triangle {
+        Vector2 vertices[3];
+    };
+
+    struct Line {
+        Vector2 start;
+        Vector2 end;
+        float thickness;
+    };
+
+    Type type;
+    RenderLayer layer;
+    // sectors only
+    uint16_t segments;
+    Color color;
+    union {
+        Circle circle;
+        Triangle triangle;
+        Rectangle rectangle;
+        Line line;
+        // see RenderCommandBuffer::getCachedLayer()
+        uint32_t cachedLayer;
+    };
+};
+
+/**
+ * @brief Draws recorded by render() methods, to be replayed by a backend later.
+ *
+ * Recording only fills an array, so what a frame draws can be sorted,
+ * counted or inspected without a window. Commands are tagged with the
+ * layer set when they were recorded, and sort() groups them by layer and
+ * then by type, so the backend switches primitives as rarely as possible.
+ * Storage is kept across clear(), so recording a frame doesn't allocate
+ * once the buffer has grown to fit one.
+ *
+ * A buffer holds on to the wall layers it draws, so it can be drawn on
+ * another thread while the simulation keeps changing.
+ */
+class RenderCommandBuffer {
+    std::vector<RenderCommand> commands;
+    // sort() destination, swapped with commands
+    std::vector<RenderCommand> sorted;
+    std::vector<std::shared_ptr<const WallOutlines>> cachedLayers;
+    RenderLayer layer = RenderLayer::EXPLOSIONS;
+
+    RenderCommand& push(RenderCommand::Type type, Color color);
+public:
+    /**
+     * @brief Layer the following commands are drawn in.
+     */
+    void setLayer(RenderLayer layer);
+
+    void circle(Vector2 center, float radius, Color color);
+    void circleLines(Vector2 center, float radius, Color color);
+    void circleSector(Vector2 center, float radius, float startAngle, float endAngle, int segments, Color color);
+    void circleSectorLines(Vector2 center, float radius, float startAngle, float endAngle, int segments, Color color);
+    void triangleLines(Vector2 v1, Vector2 v2, Vector2 v3, Color color);
+    void rectangleLines(Rectangle rectangle, Color color);
+    void line(Vector2 start, Vector2 end, float thickness, Color color);
+    void cachedLayer(std::shared_ptr<const WallOutlines> outlines);
+
+    /**
+     * @brief Copies every command of another buffer, moving them to the current layer.
+     */
+    void append(const RenderCommandBuffer& other);
+
+    /**
+     * @brief Orders commands by layer, then by type, keeping the recorded order otherwise.
+     */
+    void sort();
+
+    void clear();
+
+    /**
+     * @brief Replaces the commands by ones in between those of two buffers.
+     *
+     * Both must have been recorded from the same entities, only moved, and
+     * sorted the same way. If they weren't, the commands of to are used as is.
+     *
+     * @param alpha [0, 1] 0 being from and 1 to.
+     */
+    void interpolate(const RenderCommandBuffer& from, const RenderCommandBuffer& to, float alpha);
+
+    std::span<const RenderCommand> view() const;
+    size_t size() const;
+    size_t count(RenderCommand::Type type) const;
+    const std::shared_ptr<const WallOutlines>& getCachedLayer(const RenderCommand& command) const;
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "level.hpp"
+#include "simulation.hpp"
+
+/*
+ * Replay file layout, all values in native byte order:
+ *
+ *   header:  "RJRP", u16 version, u16 player count, f32 step interval, u32 keyframe interval,
+ *            u8 explosion detection, u8 timer wheel,
+ *            u64 Level::hash(), u16 length, level path of that length, empty for the builtin level
+ *   records: u8 kind followed by
+ *            INPUT:    varint ticks since previous record, varint player, u8 buttons, f32 x, f32 y
+ *            KEYFRAME: u64 tick, u32 size, Simulation::saveSnapshot() bytes
+ *            END:      u64 total ticks
+ *   index:   u64 count, count * (u64 tick, u64 offset of the KEYFRAME record)
+ *   footer:  u64 offset of the index, "RJIX"
+ *
+ * A keyframe is stored every `keyframe interval` ticks, starting at tick 0,
+ * so the keyframe for any tick is found by a division and one index lookup.
+ * Input records after a keyframe are delta-coded against its tick.
+ *
+ * Both the recording and every playback rebuild the Box2D world at each
+ * keyframe tick, so a playback that seeked to a keyframe steps on exactly
+ * like the recording did, see Simulation::rebuildWorld().
+ */
+
+constexpr uint32_t REPLAY_DEFAULT_KEYFRAME_INTERVAL = 600;
+
+class ReplayWriter {
+    std::ofstream file;
+    const uint32_t keyframeInterval;
+    std::vector<std::pair<uint64_t, uint64_t>> index;
+    std::vector<uint8_t> buffer;
+    Snapshot keyframe;
+    uint64_t currentTick;
+    uint64_t lastRecordTick = 0;
+    bool finished = false;
+
+    void writeBuffer();
+    void writeKeyframe(Simulation& simulation);
+public:
+    /**
+     * @brief Starts recording to a file, capturing the simulation as the first keyframe.
+     *
+     * The simulation's world is rebuilt after every keyframe, see afterStep().
+     *
+     * @param path Where to write the replay. Overwritten if it exists.
+     * @param simulation The simulation to be recorded, must be at a keyframe tick.
+     * @param keyframeInterval How many ticks apart full state keyframes are stored.
+     * @param levelPath Where the simulation's level was loaded from, as
+     * given to loadLevel(), empty for the builtin level. Streamed levels
+     * can't be recorded.
+     * @param level The level the simulation was built with, checked on playback.
+     */
+    ReplayWriter(
+        std::string_view path,
+        Simulation& simulation,
+        uint32_t keyframeInterval = REPLAY_DEFAULT_KEYFRAME_INTERVAL,
+        std::string_view levelPath = "",
+        const Level& level = Level::builtin()
+    );
+    ~ReplayWriter();
+
+    /**
+     * @brief Records input that was applied to the simulation before its next step.
+     */
+    void recordInput(const Simulation& simulation, size_t playerIndex, const TickInput& input);
+
+    /**
+     * @brief Stores a keyframe if one is due. Must be called after every step.
+     *
+     * Rebuilds the simulation's world after storing a keyframe, which is
+     * what a playback seeking to it starts from.
+     */
+    void afterStep(Simulation& simulation);
+
+    /**
+     * @brief Writes the index and closes the file. Called by the destructor if needed.
+     */
+    void finish();
+};
+
+class ReplayReader {
+    struct Record {
+        enum Kind: uint8_t {
+            INPUT = 1,
+            KEYFRAME = 2,
+            END = 3,
+        };
+        Kind kind;
+        uint64_t tick;
+        size_t playerIndex;
+        TickInput input;
+    };
+
+    std::ifstream file;
+    uint16_t players;
+    uint32_t keyframeInterval;
+    SimulationOptions options;
+    uint64_t levelHash;
+    std::string levelPath;
+    uint64_t totalTicks;
+    std::vector<std::pair<uint64_t, uint64_t>> index;
+    std::vector<uint8_t> buffer;
+    Snapshot keyframe;
+    Record next = {Record::END, 0, 0, {}};
+
+    void readRecord();
+    void loadKeyframe(Simulation& simulation);
+public:
+    /**
+     * @brief Opens a replay and reads its index.
+     * @throws std::runtime_error If the file isn't a complete replay.
+     */
+    ReplayReader(std::string_view path);
+
+    /**
+     * @brief Total number of ticks recorded.
+     */
+    uint64_t length() const;
+
+    /**
+     * @brief Amount of players the simulation that was recorded had.
+     */
+    size_t playerCount() const;
+
+    /**
+     * @brief Options the simulation that was recorded had.
+     */
+    const SimulationOptions& getSimulationOptions() const;
+
+    /**
+     * @brief Loads the level the simulation that was recorded was built with.
+     *
+     * A level recorded from a file is loaded from the same path again, so
+     * relative paths are resolved against the current directory.
+     *
+     * @throws std::runtime_error If the level can't be loaded, or has changed since the recording.
+     */
+    Level loadRecordedLevel() const;
+
+    /**
+     * @brief Puts the simulation in the state it had right before the given tick was stepped.
+     *
+     * The simulation must have been constructed with playerCount() players,
+     * getSimulationOptions() and loadRecordedLevel().
+     *
+     * Restores the closest keyframe and simulates the ticks between it and
+     * the target, so the cost is bounded by the keyframe interval, no
+     * matter how long the replay is. The state reached is the one the
+     * recording had, whatever the simulation went through before.
+     */
+    void seek(Simulation& simulation, uint64_t tick);
+
+    /**
+     * @brief Applies every input recorded for the simulation's next step.
+     *
+     * The simulation must have been seeked by this reader, and advanced
+     * only by calls to this followed by step(). Rebuilds its world at
+     * keyframe ticks, as the recording did.
+     */
+    void applyInputs(Simulation& simulation);
+};
@@ -10,17 +10,32 @@ class Rocket: public Entity {
     float remainingTime;
     bool wasDestroyed;
 
-    std::array<b2Vec2, 3> localCoordsVertices;
+    // around the center, in pixels, turned once so drawing only moves them
+    std::array<Vector2, 3> pixelVertices;
 public:
     static constexpr float lifetime = 0.3f;
     // TODO should rockets inherit velocity from player?
 
+    struct State {
+        BodyState body;
+        b2Vec2 direction;
+        float remainingTime;
+        bool wasDestroyed;
+        uint8_t padding[3] = {};
+    };
+
     // direction will be normalized internally, can accept any non-null vector
     Rocket(b2World& world, b2Vec2 position, b2Vec2 direction);
 
-    void render() const;
+    void render(RenderCommandBuffer& commands, float alpha) const;
+    // in meters, covers whatever render() draws at any alpha
+    b2AABB renderBounds() const;
     void update(float deltaTime);
     bool shouldExplodeByAge() const;
     bool hasExploded() const;
     void collide();
+    b2Vec2 getDirection() const;
+    State saveState() const;
+    // the shape is fixed at construction, state.direction must point the same way
+    void loadState(const State& state);
 };
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "simulation.hpp"
+#include "transport.hpp"
+
+struct RollbackOptions {
+    // ticks local input is held back before being applied, hiding that
+    // much of the latency without rolling back
+    uint32_t inputDelay = 2;
+    // how far past the last confirmed remote input the simulation may run
+    // before it waits, which bounds how many ticks a rollback resimulates
+    uint32_t maxRollbackTicks = 8;
+    // how often, in ticks, the peers compare checksums of confirmed state
+    uint32_t checksumInterval = 30;
+    // how often, in ticks, the world is rebuilt, see Simulation::rebuildWorld().
+    // Rollbacks resimulate from the last rebuild before the misprediction,
+    // so this trades rebuilds while nothing goes wrong for deeper rollbacks.
+    uint32_t rebuildInterval = 8;
+};
+
+/**
+ * @brief Keeps a two player Simulation in sync with a remote peer by rolling back.
+ *
+ * The local player's input is applied right away, after the input delay,
+ * and the remote player is predicted to keep aiming where they last did
+ * without pressing anything. When the remote input for a tick arrives and
+ * differs from the prediction, the simulation is restored from a snapshot
+ * taken at or before that tick and resimulated up to the present, all
+ * within a single advance() call.
+ *
+ * Every rebuildInterval ticks, counting from the tick the session started
+ * at, the world is rebuilt with Simulation::rebuildWorld(), and rollbacks
+ * only ever restore the snapshots of those ticks. Stepping on from a
+ * rebuilt world only depends on the simulation state, so resimulating
+ * with the same inputs gives the same state, bit for bit.
+ *
+ * Both peers must use the same RollbackOptions and SimulationOptions, and
+ * start from the same state. Every checksumInterval ticks they compare
+ * snapshot checksums of confirmed state, to detect desyncs.
+ */
+class RollbackSession {
+public:
+    struct Stats {
+        uint64_t rollbacks = 0;
+        uint64_t resimulatedTicks = 0;
+        // advance() calls that didn't step, waiting for the remote peer
+        uint64_t stalls = 0;
+        uint32_t maxRollbackDepth = 0;
+    };
+
+    /**
+     * @brief Construct a new RollbackSession object.
+     *
+     * @param simulation A two player simulation, driven only through this session from now on.
+     * @param localPlayer Index of the player controlled on this machine, 0 or 1.
+     * @param transport Connection to the remote peer.
+     * @throws std::invalid_argument If the simulation doesn't have two players,
+     * an interval is 0, or the options don't fit in the input history.
+     */
+    RollbackSession(
+        Simulation& simulation,
+        size_t localPlayer,
+        Transport& transport,
+        RollbackOptions options = {}
+    );
+
+    RollbackSession(const RollbackSession&) = delete;
+    RollbackSession& operator=(const RollbackSession&) = delete;
+
+    /**
+     * @brief Exchanges inputs with the peer and advances the simulation by one tick.
+     *
+     * Call once per fixed step. Rolls back first if remote input that
+     * arrived contradicts a prediction.
+     *
+     * @param localInput Local player's input, applied inputDelay ticks from now.
+     * @return true If the simulation was stepped, false if it's too far
+     * ahead of the remote peer and localInput was dropped.
+     */
+    bool advance(const TickInput& localInput);
+
+    /**
+     * @brief Ticks before this one only ever saw confirmed input from both players.
+     */
+    uint64_t confirmedTick() const;
+
+    /**
+     * @brief Earliest tick whose checksum didn't match the peer's, if any.
+     */
+    std::optional<uint64_t> desyncTick() const;
+
+    const Stats& getStats() const;
+private:
+    struct Checksum {
+        uint64_t tick = UINT64_MAX;
+        uint64_t value = 0;
+    };
+
+    // must hold every input that can still be resent or resimulated
+    static constexpr uint32_t inputHistory = 256;
+    static constexpr uint32_t checksumHistory = 16;
+
+    Simulation& simulation;
+    Transport& transport;
+    const RollbackOptions options;
+    const uint64_t startTick;
+    const size_t localPlayer;
+    const size_t remotePlayer;
+
+    // indexed by tick % inputHistory
+    std::vector<TickInput> localInputs;
+    // confirmed below remoteReceived, the predictions that were used above it
+    std::vector<TickInput> remoteInputs;
+    // indexed by tick % (maxRollbackTicks + rebuildInterval), each taken
+    // before stepping that tick, and before rebuilding the world on it
+    std::vector<Snapshot> snapshots;
+    // the tick of the latest snapshot, so stalls don't take it again
+    uint64_t snapshotTick = UINT64_MAX;
+
+    // next tick to record local input for
+    uint64_t localNext;
+    // next local tick the peer is missing
+    uint64_t localAcked = 0;
+    // next tick remote input is missing for
+    uint64_t remoteReceived;
+    // next multiple of checksumInterval to take a checksum of
+    uint64_t nextChecksumTick = 0;
+
+    std::array<Checksum, checksumHistory> localChecksums;
+    std::array<Checksum, checksumHistory> remoteChecksums;
+    Checksum latestLocalChecksum;
+    std::optional<uint64_t> firstDesync;
+
+    Stats stats;
+    std::vector<uint8_t> packet;
+
+    void receivePackets(uint64_t& rollbackTo);
+    void readPacket(uint64_t& rollbackTo);
+    void sendPacket();
+    void rollback(uint64_t tick);
+    void stepWithInputs();
+    void saveSnapshot();
+    uint64_t oldestSnapshotTick() const;
+    void updateChecksums();
+    void compareChecksums(uint64_t tick);
+};
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <box2d/box2d.h>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "player.hpp"
+#include "wall.hpp"
+#include "rocket.hpp"
+#include "explosion.hpp"
+#include "recoilwave.hpp"
+#include "contactlistener.hpp"
+#include "pool.hpp"
+#include "timerwheel.hpp"
+#include "level.hpp"
+#include "levelstreamer.hpp"
+#include "walllayer.hpp"
+
+/**
+ * @brief Mouse state for a single simulation tick, already converted to world coordinates.
+ */
+struct TickInput {
+    b2Vec2 target = {0, 0};
+    bool leftPressed = false;
+    bool leftReleased = false;
+    bool rightPressed = false;
+    bool rightReleased = false;
+
+    bool operator==(const TickInput& other) const = default;
+};
+
+/**
+ * @brief Choices that change how a Simulation plays out, so replays record them.
+ */
+struct SimulationOptions {
+    // how explosions find the players and rockets they reach
+    ExplosionDetection explosionDetection = ExplosionDetection::SENSOR_BODIES;
+    // drive every player and recoil wave timer from one TimerWheel,
+    // instead of updating each of them every step
+    bool timerWheel = false;
+};
+
+/**
+ * @brief Flat copy of a whole Simulation, see Simulation::saveSnapshot().
+ *
+ * Plain bytes at fixed offsets, with no pointers, so it can be copied with
+ * memcpy and compared byte for byte. Its size only depends on the player
+ * count, a Snapshot reused for the same simulation is never reallocated.
+ */
+class Snapshot {
+    std::vector<uint8_t> bytes;
+    friend class Simulation;
+public:
+    const uint8_t *data() const { return bytes.data(); }
+    size_t size() const { return bytes.size(); }
+    // copies bytes of a snapshot kept elsewhere, e.g. in a replay, loadSnapshot() checks them
+    void assign(const uint8_t *data, size_t size) { bytes.assign(data, data + size); }
+    // FNV-1a of the bytes, for comparing snapshots taken on different machines
+    uint64_t checksum() const;
+    bool operator==(const Snapshot& other) const = default;
+};
+
+/**
+ * @brief Owns the whole game state and advances it in fixed steps.
+ *
+ * Nothing here depends on a window being open, so it can be stepped
+ * headless as fast as the CPU allows, or driven by the game loop.
+ */
+class Simulation {
+    // everything that belongs to a single player
+    struct PlayerEntities {
+        Player player;
+        RecoilWave recoilWave;
+        std::array<Rocket *, Player::maxRockets> rockets;
+        int rocketIndex = 0;
+
+        PlayerEntities(
+            b2World& world,
+            b2Vec2 position,
+            size_t explosionCapacity,
+            TimerWheel *timerWheel
+        );
+    };
+
+    const SimulationOptions options;
+    b2World world;
+
+    // declared after the world so they are destroyed before it
+    Pool<Rocket> rocketPool;
+    ExplosionSystem explosions;
+    // declared before the players so their timers are destroyed first
+    std::optional<TimerWheel> timerWheel;
+
+    // deque so players never move, fixtures point to them
+    std::deque<PlayerEntities> players;
+    std::deque<Wall> walls;
+    // a cache, filled in by render()
+    mutable WallLayer wallLayer;
+    std::optional<LevelStreamer> levelStreamer;
+    std::vector<b2Vec2> streamingFocus;
+
+    ContactListener contactListener;
+    uint64_t currentTick = 0;
+    // set by loadSnapshot() and rebuildWorld(), players' nearby explosions
+    // may hold overlaps that ended, which no contact will report
+    bool nearbyExplosionsRestored = false;
+    // reused by rebuildWorld()
+    std::vector<Entity::Blueprint> blueprints;
+
+    // every entity with a body, always in the same order
+    template<typename F>
+    void forEachEntity(F&& function);
+    void feelNearbyExplosions(Player& player);
+    void updatePlayers();
+    void updateRockets();
+    void savePreviousPositions();
+    void updateLevelStreaming();
+    size_t playerSnapshotSize() const;
+public:
+    // A rocket explodes at most twice: one that runs out of time explodes
+    // where it is but stays alive, and its own explosion sets it off again
+    // on the next step. Its explosions start within Rocket::lifetime and a
+    // step of it being fired, and last ExplosionSystem::lifetime, too short
+    // a window for more than one reload to finish, so the rockets of at
+    // most a full magazine and one reload can have explosions alive at once.
+    static constexpr size_t explosionsPerRocket = 2;
+    static constexpr size_t maxExplosionsPerPlayer = explosionsPerRocket * (Player::maxRockets + 1);
+
+    /**
+     * @brief Construct a new Simulation object.
+     *
+     * @param playerCount How many players to spawn, side by side over the ground.
+     * @param options How the simulation plays out.
+     * @param level Terrain to start with.
+     */
+    explicit Simulation(
+        size_t playerCount = 1,
+        SimulationOptions options = {},
+        const Level& level = Level::builtin()
+    );
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    /**
+     * @brief Adds static terrain, only between steps.
+     *
+     * Walls aren't part of saveState(), a simulation loading a state must
+     * have the same walls as the one that saved it.
+     *
+     * @param position Top left corner, in meters.
+     * @param dimensions Width and height, in meters.
+     */
+    void addWall(b2Vec2 position, b2Vec2 dimensions);
+
+    /**
+     * @brief Streams a level's walls in and out around the players from now
+     * on, on top of any other walls. Only between steps.
+     *
+     * Blocks until the chunks around the players are in. Later ones are
+     * read in the background and get their bodies created at the start of
+     * a step, so which walls exist on a given tick depends on disk timing:
+     * streamed levels are meant for play, not replays or rollback.
+     */
+    void streamLevel(ChunkedLevel level, LevelStreamingOptions streamingOptions = {});
+
+    /**
+     * @brief Applies player input, to be simulated on the next call to step().
+     *
+     * @param playerIndex Which player the input belongs to, in the [0, playerCount()) range.
+     */
+    void applyInput(size_t playerIndex, const TickInput& input);
+
+    /**
+     * @brief Advances the simulation by SIMULATION_STEP_INTERVAL.
+     */
+    void step();
+
+    /**
+     * @brief Records the commands drawing every entity, to be drawn once sorted.
+     *
+     * @param commands Buffer the commands are appended to. Walls are
+     * recorded as shared references to their cached outlines, which the
+     * buffer keeps alive, so it can still be drawn, e.g. on another thread,
+     * after the simulation has stepped or its walls have changed.
+     * @param alpha [0, 1] How far between the previous and the current step to draw entities.
+     * @param view If not nullptr, only what overlaps this area, in meters, is recorded.
+     */
+    void render(RenderCommandBuffer& commands, float alpha = 1.0f, const b2AABB *view = nullptr) const;
+
+    /**
+     * @brief Number of times step() has been called since construction.
+     */
+    uint64_t tick() const;
+
+    /**
+     * @brief Appends the complete simulation state to a buffer.
+     *
+     * Only valid between steps, never from inside a contact callback.
+     */
+    void saveState(std::vector<uint8_t>& out) const;
+
+    /**
+     * @brief Replaces the simulation state with one captured by saveState().
+     *
+     * Rockets and explosions get new bodies, and players' nearby explosions
+     * are emptied, so the next step finds what explosions reach from
+     * scratch. Players keep their bodies and Box2D keeps their contacts
+     * with walls, which aren't part of the state, so stepping on may
+     * differ by float rounding from the simulation the state came from.
+     */
+    void loadState(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Size of every Snapshot of this simulation.
+     */
+    size_t snapshotSize() const;
+
+    /**
+     * @brief Captures the complete simulation state, for rollback and rewinding.
+     *
+     * Unlike saveState(), every slot is copied whether it's in use or not,
+     * so this is a handful of memcpy calls into a buffer that is only
+     * allocated the first time. Only valid between steps.
+     */
+    void saveSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * @brief Replaces the simulation state with one captured by saveSnapshot().
+     *
+     * Explosions get new sensor bodies, which Box2D reports touching players
+     * and rockets on the next step, and players' nearby explosions are
+     * restored, minus the ones that no longer reach them by then. Rockets
+     * alive both now and in the snapshot keep their bodies, which is safe
+     * since a rocket that touches anything explodes. Box2D contacts between
+     * players and walls are kept as they are, so as with loadState(),
+     * stepping on may differ by float rounding, unless both simulations
+     * call rebuildWorld() first.
+     *
+     * @throws std::invalid_argument If the snapshot belongs to a simulation
+     * with a different player count.
+     */
+    void loadSnapshot(const Snapshot& snapshot);
+
+    /**
+     * @brief Creates the Box2D world and every body in it anew, from the
+     * simulation state alone. Only between steps.
+     *
+     * Box2D keeps contacts, warm starting impulses and sleep timers that
+     * no snapshot has, and solves bodies in an order that depends on when
+     * they were created. Right after this, a step only depends on the
+     * simulation state, so a simulation that loaded a snapshot and one
+     * that got there by stepping agree, as long as both rebuilt their
+     * worlds before every step since. Bodies rebuilt every step never
+     * fall asleep.
+     */
+    void rebuildWorld();
+
+    size_t playerCount() const;
+    const SimulationOptions& getOptions() const;
+    const Player& getPlayer(size_t index = 0) const;
+    const ExplosionSystem& getExplosions() const;
+};
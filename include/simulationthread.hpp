@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "simulation.hpp"
+#include "replay.hpp"
+#include "rendercommands.hpp"
+#include "triplebuffer.hpp"
+
+/**
+ * @brief Everything needed to draw the simulation as it was after a step.
+ */
+struct RenderFrame {
+    // the step's start and end, drawn in between
+    RenderCommandBuffer previous;
+    RenderCommandBuffer current;
+    uint64_t tick = 0;
+    std::chrono::steady_clock::time_point steppedAt;
+
+    // the first player's, for the debug overlay
+    int rocketAmmo = 0;
+    float rocketReload = 0;
+    float recoilReload = 0;
+
+    /**
+     * @brief How far between previous and current to draw at a point in
+     * time, in [0, 1], assuming the next step comes one interval after this one.
+     */
+    float alphaAt(std::chrono::steady_clock::time_point time) const;
+};
+
+/**
+ * @brief Steps a simulation on its own thread, at SIMULATION_STEP_INTERVAL,
+ * however long frames take to draw.
+ *
+ * After every batch of steps it records a RenderFrame and publishes it
+ * through a TripleBuffer, so the thread drawing takes the latest one
+ * without locks and never waits for a step, nor a step for a frame. Input
+ * is queued by the drawing thread and applied before the next step, and
+ * frames only hold what's in the view it last set.
+ *
+ * The simulation and the recorder must not be touched by anything else
+ * while this exists.
+ */
+class SimulationThread {
+    Simulation& simulation;
+    ReplayWriter *recorder;
+    TripleBuffer<RenderFrame> frames;
+
+    // guards what the drawing thread hands over
+    std::mutex inputMutex;
+    // applied in order to the first player before the next step
+    std::vector<TickInput> queuedInputs;
+    // swapped with queuedInputs, to apply them outside the lock
+    std::vector<TickInput> takenInputs;
+    std::optional<b2AABB> view;
+
+    std::atomic<bool> stopping = false;
+    // last, so it starts once everything it uses is constructed
+    std::thread thread;
+
+    void run();
+    void applyQueuedInputs();
+    void publishFrame();
+public:
+    /**
+     * @brief Publishes a first frame and starts stepping.
+     *
+     * @param recorder If not nullptr, records every input and step.
+     */
+    explicit SimulationThread(Simulation& simulation, ReplayWriter *recorder = nullptr);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    /**
+     * @brief Queues input for the first player, to be applied before the next step.
+     */
+    void queueInput(const TickInput& input);
+
+    /**
+     * @brief Limits the next frames to what overlaps an area, in meters.
+     */
+    void setView(const b2AABB& view);
+
+    /**
+     * @brief The most recently published frame, valid until the next call.
+     * Only from a single thread.
+     */
+    const RenderFrame& latestFrame();
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Vector that keeps its first N elements inline, only going to the heap past that.
+ *
+ * Once it has spilled over, the heap buffer is kept across clear() calls,
+ * so even a buffer that outgrew its inline storage stops allocating after
+ * it reaches its peak size. Elements are always contiguous.
+ */
+template<typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    std::array<T, N> inlineItems;
+    std::vector<T> heapItems;
+    T *items = inlineItems.data();
+    size_t count = 0;
+public:
+    SmallVector() = default;
+
+    // items may point into this object, copies would share it
+    SmallVector(const SmallVector&) = delete;
+    SmallVector& operator=(const SmallVector&) = delete;
+
+    void push_back(const T& item) {
+        if (items == inlineItems.data()) {
+            if (count < N) {
+                inlineItems[count++] = item;
+                return;
+            }
+            heapItems.assign(inlineItems.begin(), inlineItems.end());
+        } else {
+            heapItems.resize(count);
+        }
+        heapItems.push_back(item);
+        items = heapItems.data();
+        count++;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // whether push_back has ever had to fall back to the heap
+    bool spilled() const {
+        return items != inlineItems.data();
+    }
+
+    T& operator[](size_t index) {
+        return items[index];
+    }
+
+    const T& operator[](size_t index) const {
+        return items[index];
+    }
+
+    T *begin() {
+        return items;
+    }
+
+    T *end() {
+        return items + count;
+    }
+
+    const T *begin() const {
+        return items;
+    }
+
+    const T *end() const {
+        return items + count;
+    }
+};
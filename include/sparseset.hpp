@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Set of integers in the [0, capacity) range.
+ *
+ * Insertion, removal and lookup are O(1), and iteration walks a dense
+ * array of the members, in no particular order. Memory is allocated
+ * once, at construction.
+ */
+class SparseSet {
+    std::vector<uint32_t> dense;
+    std::vector<uint32_t> sparse;
+public:
+    /**
+     * @brief Construct a new SparseSet object.
+     *
+     * @param capacity One past the largest value that can be stored.
+     */
+    explicit SparseSet(size_t capacity);
+
+    /**
+     * @brief Adds a value to the set.
+     * @return true If the value was not in the set yet.
+     */
+    bool insert(uint32_t value);
+
+    /**
+     * @brief Removes a value from the set.
+     * @return true If the value was in the set.
+     */
+    bool erase(uint32_t value);
+
+    bool contains(uint32_t value) const;
+    void clear();
+    size_t size() const;
+    size_t capacity() const;
+
+    const uint32_t *begin() const;
+    const uint32_t *end() const;
+};
@@ -1,18 +1,45 @@
 #pragma once
 
-#include <optional>
-#include <functional>
+#include <cstdint>
+
+#include "inplacefunction.hpp"
+
+class TimerWheel;
 
 class Timer {
     const float len;
     float elapsed;
-    std::function<void()> action;
+    InplaceFunction<void()> action;
     bool didAction = false;
+    bool running = true;
+
+    // only used when driven by a TimerWheel
+    TimerWheel *wheel = nullptr;
+    uint32_t lengthTicks = 0;
+    // tick the timer would have started at had it never been paused, while running
+    uint64_t startTick = 0;
+    // ticks elapsed when it was paused, while not running
+    uint64_t pausedTicks = 0;
+    uint64_t deadline = 0;
+    Timer *wheelNext = nullptr;
+    // address of the pointer pointing to this timer, nullptr if not scheduled
+    Timer **wheelPrevNext = nullptr;
+
+    friend class TimerWheel;
 
     void performAction();
+    uint64_t elapsedTicks() const;
+    float currentElapsed() const;
+    void schedule();
 public:
     using Action = decltype(action);
 
+    struct State {
+        float elapsed;
+        bool didAction;
+        uint8_t padding[3] = {};
+    };
+
     /**
      * @brief Construct a new Timer object.
      *
@@ -25,8 +52,15 @@ public:
      *
      * @param length Time length of the Timer.
      * @param autoAction Action to take automatically when timer concludes.
+     * @param timerWheel If not nullptr, the Timer follows the wheel instead of update(),
+     * which must outlive it.
      */
-    Timer(float length, Action autoAction);
+    Timer(float length, Action autoAction, TimerWheel *timerWheel = nullptr);
+    ~Timer();
+
+    // the wheel links to the timer's address
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
 
     /**
      * @brief Checks whether or not the timer has finished.
@@ -54,6 +88,11 @@ public:
      */
     void setToComplete();
 
+    /**
+     * @brief Pauses or resumes the timer. Paused timers keep their progress.
+     */
+    void setRunning(bool run);
+
     /**
      * @brief Checks the full length of the Timer.
      * @return float The length of time the Timer takes to complete from a reset.
@@ -61,7 +100,8 @@ public:
     float length() const;
 
     /**
-     * @brief Progress along timer a given amount of time.
+     * @brief Progress along timer a given amount of time. Does nothing when
+     * paused or driven by a TimerWheel.
      * @param deltaTime How much time has elapsed since construction or last call to update.
      */
     void update(float deltaTime);
@@ -83,4 +123,14 @@ public:
      * @return float The amount of time that has passed.
      */
     float timeElapsed() const;
+
+    /**
+     * @brief Captures the progress of the timer, without its action.
+     */
+    State saveState() const;
+
+    /**
+     * @brief Restores progress captured by saveState(). The action is not performed.
+     */
+    void loadState(const State& state);
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Timer;
+
+/**
+ * @brief Advances every Timer registered to it at once, in fixed ticks.
+ *
+ * Timers are bucketed by the tick they expire on, so advancing only visits
+ * the timers expiring on the new tick, no matter how many are waiting.
+ * Timers that expire more than slotCount ticks ahead share buckets with
+ * closer ones and are skipped over until their tick comes.
+ */
+class TimerWheel {
+    const float interval;
+    uint64_t currentTick = 0;
+    std::vector<Timer *> slots;
+    // timers expired on the current tick, waiting for their action
+    Timer *due = nullptr;
+
+    friend class Timer;
+
+    void schedule(Timer& timer, uint64_t deadline);
+    static void link(Timer **head, Timer& timer);
+    static void unlink(Timer& timer);
+public:
+    /**
+     * @brief Construct a new TimerWheel object.
+     *
+     * @param tickInterval Time that passes on every call to advance().
+     * @param slotCount Amount of buckets, rounded up to a power of 2.
+     * Ideally more ticks than the longest timer takes.
+     */
+    explicit TimerWheel(float tickInterval, size_t slotCount = 256);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief Moves to the next tick and performs the actions of the timers expiring on it.
+     */
+    void advance();
+
+    /**
+     * @brief Number of times advance() has been called since construction.
+     */
+    uint64_t now() const;
+
+    float tickInterval() const;
+
+    /**
+     * @brief Number of ticks it takes for a duration to pass, at least 1.
+     */
+    uint32_t ticksFor(float duration) const;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Unreliable, unordered datagrams between two peers.
+ *
+ * Packets may arrive late, out of order, or not at all, so whatever sits on
+ * top has to cope with the same things it would over UDP.
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual void send(const std::vector<uint8_t>& packet) = 0;
+
+    /**
+     * @brief Takes the next packet that has arrived, if any.
+     *
+     * @param packet Replaced with the packet's bytes, reusing its storage.
+     * @return true If a packet was taken.
+     */
+    virtual bool receive(std::vector<uint8_t>& packet) = 0;
+};
+
+struct LoopbackOptions {
+    // one-way delay every packet gets, in seconds
+    float latency = 0.05f;
+    // extra delay, uniformly distributed in [0, jitter), which also reorders packets
+    float jitter = 0.0f;
+    // [0, 1] chance of a packet being dropped
+    float loss = 0.0f;
+    uint32_t seed = 1;
+};
+
+/**
+ * @brief Two Transport endpoints connected in memory, with simulated network conditions.
+ *
+ * Time only moves when advance() is called, so a whole match between two
+ * sessions can be played out deterministically, and faster than real
+ * time, on a single thread.
+ */
+class LoopbackLink {
+    struct InFlight {
+        double deliverAt;
+        // breaks ties, so packets with the same delivery time keep their order
+        uint64_t sequence;
+        std::vector<uint8_t> bytes;
+    };
+
+    class Endpoint: public Transport {
+        LoopbackLink& link;
+        // packets headed to this endpoint, unsorted
+        std::vector<InFlight> incoming;
+        Endpoint *peer = nullptr;
+        friend class LoopbackLink;
+    public:
+        explicit Endpoint(LoopbackLink& link): link(link) {}
+        void send(const std::vector<uint8_t>& packet) override;
+        bool receive(std::vector<uint8_t>& packet) override;
+    };
+
+    const LoopbackOptions options;
+    std::mt19937 random;
+    double now = 0;
+    uint64_t nextSequence = 0;
+    Endpoint first;
+    Endpoint second;
+public:
+    explicit LoopbackLink(LoopbackOptions options = {});
+
+    LoopbackLink(const LoopbackLink&) = delete;
+    LoopbackLink& operator=(const LoopbackLink&) = delete;
+
+    /**
+     * @brief One side of the link, index 0 or 1. Sending on one receives on the other.
+     */
+    Transport& endpoint(size_t index);
+
+    /**
+     * @brief Moves the link's clock forward, delivering packets that are due.
+     */
+    void advance(float seconds);
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Hands the latest of a stream of values from one thread to another without locks.
+ *
+ * The writer fills its buffer and publishes it, the reader takes the most
+ * recently published one. A third buffer sits in between, so neither ever
+ * waits for the other, and the reader simply skips values published while
+ * it was busy. Buffers are reused, values are never copied.
+ *
+ * Exactly one thread may write and one other may read.
+ */
+template<typename T>
+class TripleBuffer {
+    // set on the shared index while it holds a value the reader hasn't taken
+    static constexpr uint8_t freshBit = 4;
+
+    std::array<T, 3> buffers;
+    uint8_t writing = 0;
+    uint8_t reading = 1;
+    // on its own cache line, it's the only thing both threads touch
+    alignas(64) std::atomic<uint8_t> shared = 2;
+public:
+    /**
+     * @brief The buffer the writer fills, holding whatever it held three publishes ago.
+     */
+    T& writeBuffer() {
+        return buffers[writing];
+    }
+
+    /**
+     * @brief Makes the write buffer the latest value, and gives the writer another one.
+     */
+    void publish() {
+        writing = shared.exchange(writing | freshBit, std::memory_order_acq_rel) & ~freshBit;
+    }
+
+    /**
+     * @brief Takes the latest published value if it's newer than the read buffer.
+     *
+     * @return true If the read buffer changed.
+     */
+    bool update() {
+        if ((shared.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+        reading = shared.exchange(reading, std::memory_order_acq_rel) & ~freshBit;
+        return true;
+    }
+
+    /**
+     * @brief The value taken by the last update(), unchanged until the next one.
+     */
+    const T& readBuffer() const {
+        return buffers[reading];
+    }
+};
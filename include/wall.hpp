@@ -8,5 +8,7 @@ class Wall: public Entity {
 public:
     Wall(b2World& world, b2Vec2 position, b2Vec2 dimensions);
     void update(float deltaTime) {}
-    void render() const;
+    void render(RenderCommandBuffer& commands, float alpha) const;
+    // what render() covers, in raylib coordinates
+    Rectangle pixelBounds() const;
 };
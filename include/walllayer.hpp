@@ -0,0 +1,107 @@
+#pragma once
+
+#include <raylib.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+#include "wall.hpp"
+#include "rendercommands.hpp"
+
+/**
+ * @brief What a WallLayer recorded. Never changes once shared, so frames
+ * drawing it on another thread can keep it after the walls have changed.
+ */
+struct WallOutlines {
+    RenderCommandBuffer commands;
+    // in raylib coordinates, covers every outline
+    Rectangle bounds = {};
+};
+
+/**
+ * @brief Outlines of a group of walls that never move, drawn once into a texture.
+ *
+ * The outlines are recorded when the walls change, and every frame after
+ * that records a single command for the whole group, however many walls
+ * it has. The backend keeps the texture, drawing the outlines into it the
+ * first time it sees them. Owners call invalidate() whenever walls are
+ * added to or removed from the group. Groups too large for a texture
+ * record their outlines one by one instead.
+ */
+class WallLayer {
+    static std::atomic<bool> cachingEnabled;
+
+    std::shared_ptr<const WallOutlines> outlines;
+
+    template<typename Walls>
+    void record(const Walls& walls);
+public:
+    // texture pixels per raylib pixel, matching the camera zoom keeps lines crisp
+    static constexpr float textureScale = 2.0f;
+    static constexpr int maxTextureSize = 4096;
+
+    /**
+     * @brief Makes the next render() record the walls again.
+     */
+    void invalidate();
+
+    /**
+     * @brief Records the walls, as one command when caching.
+     *
+     * Takes the same walls as the last time unless invalidate() was called in between.
+     *
+     * @param view If not nullptr, nothing is recorded if the walls are all
+     * outside this area, in pixels, and without caching only the walls
+     * overlapping it are.
+     */
+    template<typename Walls>
+    void render(RenderCommandBuffer& commands, const Walls& walls, const Rectangle *view = nullptr);
+
+    /**
+     * @brief Turns caching on or off for every layer, to compare both ways of drawing.
+     * Takes effect the next time layers are recorded, from any thread.
+     */
+    static void setCachingEnabled(bool enabled);
+    static bool isCachingEnabled();
+
+    static bool fitsTexture(Rectangle bounds);
+};
+
+template<typename Walls>
+void WallLayer::record(const Walls& walls) {
+    auto recorded = std::make_shared<WallOutlines>();
+    float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+    for (const Wall& wall: walls) {
+        wall.render(recorded->commands, 1.0f);
+        Rectangle wallBounds = wall.pixelBounds();
+        left = std::min(left, wallBounds.x);
+        top = std::min(top, wallBounds.y);
+        right = std::max(right, wallBounds.x + wallBounds.width);
+        bottom = std::max(bottom, wallBounds.y + wallBounds.height);
+    }
+    // outlines are drawn on the far edges too, a pixel of margin keeps them in
+    if (!walls.empty())
+        recorded->bounds = {left - 1, top - 1, right - left + 2, bottom - top + 2};
+    outlines = std::move(recorded);
+}
+
+template<typename Walls>
+void WallLayer::render(RenderCommandBuffer& commands, const Walls& walls, const Rectangle *view) {
+    if (!outlines)
+        record(walls);
+    if (view != nullptr && !CheckCollisionRecs(*view, outlines->bounds))
+        return;
+    if (isCachingEnabled() && fitsTexture(outlines->bounds)) {
+        commands.cachedLayer(outlines);
+        return;
+    }
+    if (view == nullptr) {
+        commands.append(outlines->commands);
+        return;
+    }
+    for (const RenderCommand& outline: outlines->commands.view()) {
+        if (CheckCollisionRecs(*view, outline.rectangle))
+            commands.rectangleLines(outline.rectangle, outline.color);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "inplacefunction.hpp"
+
+/**
+ * @brief Fixed set of threads that run parallel loops, balancing them by work stealing.
+ *
+ * Every loop is split into one contiguous range of indices per thread. A
+ * thread takes indices from the front of its own range, and once it runs
+ * out, steals the back half of another thread's range, so uneven
+ * iterations still keep every thread busy. Nothing is allocated per loop.
+ */
+class WorkStealingPool {
+public:
+    using Task = InplaceFunction<void(size_t), 4 * sizeof(void *)>;
+
+    /**
+     * @brief Threads to use to keep every core busy, counting the one calling parallelFor.
+     */
+    static size_t defaultThreadCount();
+
+    /**
+     * @brief Construct a new WorkStealingPool object.
+     *
+     * @param threadCount Threads taking part in every loop, including the
+     * one that calls parallelFor, so 1 runs everything on the caller.
+     */
+    explicit WorkStealingPool(size_t threadCount = defaultThreadCount());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Calls task(i) for every i in [0, count) and waits for all of them.
+     *
+     * Calls for different indices run concurrently, in no particular order.
+     * If any of them throws, the first exception is rethrown here once the
+     * others are done. Not reentrant.
+     */
+    void parallelFor(size_t count, Task task);
+
+    size_t threadCount() const;
+private:
+    // one per thread, on its own cache line so stealing doesn't slow down the owner
+    struct alignas(64) Range {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    std::unique_ptr<Range[]> ranges;
+    const size_t rangeCount;
+    std::vector<std::thread> threads;
+
+    Task task;
+    std::atomic<size_t> remaining = 0;
+
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    uint64_t generation = 0;
+    bool stopping = false;
+    std::exception_ptr firstException;
+
+    void threadLoop(size_t self);
+    void work(size_t self);
+    bool claim(size_t self, size_t& index);
+    bool steal(size_t self, size_t victim, size_t& index);
+};
@@ -2,10 +2,13 @@
 
 #include <raymath.h>
 #include <box2d/box2d.h>
+#include <span>
 
 constexpr float SIMULATION_STEP_INTERVAL = 1.0f / 60.0f;
 constexpr float SIMULATION_POSITION_ITER = 10.0f;
 constexpr float SIMULATION_VELOCITY_ITER = 10.0f;
+// at 60Hz, anything slower than 12 FPS starts running in slow motion
+constexpr int SIMULATION_MAX_STEPS_PER_FRAME = 5;
 
 constexpr float PIXELS_PER_METER = 10.0f;
 constexpr float METERS_PER_PIXEL = 1.0f / PIXELS_PER_METER;
@@ -20,3 +23,9 @@ constexpr float metersToPixels(float meters) {
 
 Vector2 box2dToRaylib(b2Vec2 position);
 b2Vec2 raylibToBox2d(Vector2 position);
+
+// in place, over a whole array at once so the compiler can vectorize it
+void metersToPixels(std::span<float> values);
+
+// what a camera shows of the world on a screen of the given size, in meters, ignoring rotation
+b2AABB cameraView(const Camera2D& camera, Vector2 screenSize);
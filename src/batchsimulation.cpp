@@ -0,0 +1,29 @@
+#include "batchsimulation.hpp"
+
+BatchSimulation::BatchSimulation(
+    size_t worldCount,
+    size_t playersPerWorld,
+    SimulationOptions options,
+    size_t threadCount
+):
+    pool(threadCount)
+{
+    for (size_t i = 0; i < worldCount; i++)
+        worlds.emplace_back(playersPerWorld, options);
+}
+
+size_t BatchSimulation::size() const {
+    return worlds.size();
+}
+
+size_t BatchSimulation::threadCount() const {
+    return pool.threadCount();
+}
+
+Simulation& BatchSimulation::at(size_t worldIndex) {
+    return worlds.at(worldIndex);
+}
+
+const Simulation& BatchSimulation::at(size_t worldIndex) const {
+    return worlds.at(worldIndex);
+}
@@ -0,0 +1,155 @@
+#include "contactlistener.hpp"
+
+#include <utility>
+
+#include "profiler.hpp"
+
+ContactListener::ContactListener(ExplosionSystem& explosions):
+    explosions(explosions) {}
+
+void ContactListener::BeginContact(b2Contact *contact) {
+    RJ_PROFILE_SCOPE("BeginContact");
+    using Type = Entity::EntityType;
+    Entity *a = Entity::fromFixture(contact->GetFixtureA());
+    Entity *b = Entity::fromFixture(contact->GetFixtureB());
+
+    if (b->type == Type::ROCKET) {
+        std::swap(a, b);
+    }
+
+    if (a->type == Type::ROCKET && b->type == Type::TERRAIN) {
+        // queue explosion to be created later in the frame
+
+        b2WorldManifold manifold;
+        contact->GetWorldManifold(&manifold);
+
+        // always spawns explosions in the first contact point
+        // maybe fix this later, but it probably doesn't matter
+        setupForExplosion(dynamic_cast<Rocket *>(a), manifold.points[0]);
+        return;
+    }
+
+    if (b->type == Type::EXPLOSION) {
+        std::swap(a, b);
+    }
+
+    if (a->type == Type::EXPLOSION) {
+        explosionReached(static_cast<Explosion *>(a)->getSlot(), b);
+        return;
+    }
+}
+
+void ContactListener::explosionReached(uint32_t slot, Entity *entity) {
+    using Type = Entity::EntityType;
+    Rocket *r;
+    Player *p;
+    switch (entity->type) {
+    case Type::PLAYER:
+        p = static_cast<Player *>(entity);
+        p->getNearbyExplosions().insert(slot);
+        break;
+    case Type::ROCKET:
+        r = dynamic_cast<Rocket *>(entity);
+        setupForExplosion(r, r->box2dPosition());
+        break;
+    case Type::EXPLOSION:
+        break;
+    case Type::TERRAIN:
+        // TODO destructible terrain, maybe on separate entity type
+        break;
+    case Type::RECOIL_WAVE:
+        break;
+    }
+}
+
+// Reports fixtures that overlap an explosion's hitbox
+class ExplosionQuery: public b2QueryCallback {
+    b2CircleShape hitbox;
+    b2Transform transform;
+public:
+    SmallVector<b2Fixture *, 16> reached;
+
+    ExplosionQuery() {
+        hitbox.m_radius = ExplosionSystem::hitboxRadius;
+        transform.q = b2Rot(0);
+    }
+
+    b2AABB moveTo(b2Vec2 position) {
+        transform.p = position;
+        reached.clear();
+        b2AABB aabb;
+        hitbox.ComputeAABB(&aabb, transform, 0);
+        return aabb;
+    }
+
+    bool ReportFixture(b2Fixture *fixture) {
+        // the tree only knows about bounding boxes, test the actual shapes
+        if ((fixture->GetFilterData().categoryBits & ExplosionSystem::collisionMask) != 0
+            && b2TestOverlap(&hitbox, 0, fixture->GetShape(), 0, transform, fixture->GetBody()->GetTransform())) {
+            reached.push_back(fixture);
+        }
+        return true;
+    }
+};
+
+void ContactListener::queryExplosionOverlaps(b2World& world) {
+    RJ_PROFILE_SCOPE("queryExplosionOverlaps");
+    ExplosionQuery query;
+    explosions.forEachSlot([&](uint32_t slot) {
+        world.QueryAABB(&query, query.moveTo(explosions.positionAt(slot)));
+        // collected first so the query callback doesn't need to know about players and rockets
+        for (b2Fixture *fixture: query.reached)
+            explosionReached(slot, Entity::fromFixture(fixture));
+    });
+}
+
+void ContactListener::dropUnreachedExplosions(Player& player) {
+    // the same test Box2D uses to tell whether a sensor touches a fixture
+    b2CircleShape hitbox;
+    hitbox.m_radius = ExplosionSystem::hitboxRadius;
+    b2Transform transform;
+    transform.q = b2Rot(0);
+    const b2Fixture *fixture = player.getFixture();
+
+    SparseSet& nearby = player.getNearbyExplosions();
+    SmallVector<uint32_t, 16> unreached;
+    for (uint32_t slot: nearby) {
+        transform.p = explosions.positionAt(slot);
+        if (!b2TestOverlap(&hitbox, 0, fixture->GetShape(), 0, transform, fixture->GetBody()->GetTransform()))
+            unreached.push_back(slot);
+    }
+    for (uint32_t slot: unreached)
+        nearby.erase(slot);
+}
+
+void ContactListener::EndContact(b2Contact *contact) {
+    RJ_PROFILE_SCOPE("EndContact");
+    using Type = Entity::EntityType;
+    Entity *a = Entity::fromFixture(contact->GetFixtureA());
+    Entity *b = Entity::fromFixture(contact->GetFixtureB());
+
+    if (b->type == Type::PLAYER) {
+        std::swap(a, b);
+    }
+
+    if (a->type == Type::PLAYER && b->type == Type::EXPLOSION) {
+        auto p = static_cast<Player *>(a);
+        p->getNearbyExplosions().erase(static_cast<Explosion *>(b)->getSlot());
+    }
+}
+
+void ContactListener::setupForExplosion(Rocket *rocket, b2Vec2 position) {
+    // a rocket can touch terrain and explosions in the same step,
+    // only the first contact makes it explode
+    if (rocket->hasExploded()) return;
+    rocket->collide();
+    queuedExplosions.push_back({position});
+}
+
+void ContactListener::flushQueuedExplosions() {
+    // DO NOT DELETE ROCKETS
+    // this is done in the cleanup stage of spawning explosions
+    for (const QueuedExplosion& queued: queuedExplosions)
+        explosions.spawn(queued.location);
+    queuedExplosions.clear();
+}
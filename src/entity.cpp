@@ -1,5 +1,7 @@
 #include "entity.hpp"
 
+#include <cmath>
+#include <stdexcept>
 #include <utility>
 
 #include "world.hpp"
@@ -7,13 +9,14 @@
 b2Fixture *make_fixture(
     Entity *entity,
     b2Body *body,
-    b2Shape *shape,
+    const b2Shape& shape,
     float fixtureDensity,
     int collisionCategory,
     int collisionMask
 ) {
     b2FixtureDef fixtureDef;
-    fixtureDef.shape = shape;
+    // box2d clones the shape into its own allocator
+    fixtureDef.shape = &shape;
     fixtureDef.density = fixtureDensity;
     fixtureDef.userData.pointer = entity->toUserDataPointer();
     fixtureDef.isSensor = collisionCategory == Entity::EntityType::EXPLOSION;
@@ -25,6 +28,7 @@ b2Fixture *make_fixture(
 void Entity::swap(Entity& other) {
     body = std::exchange(other.body, body);
     fixture = std::exchange(other.fixture, fixture);
+    previousPosition = std::exchange(other.previousPosition, previousPosition);
     world = std::exchange(other.world, world);
 }
 
@@ -38,7 +42,7 @@ b2BodyDef Entity::defaultBodyDef() {
 Entity::Entity(
     b2World& world,
     b2Body *body,
-    b2Shape *shape,
+    const b2Shape& shape,
     float fixtureDensity,
     EntityType type,
     int collisionMask
@@ -53,10 +57,8 @@ Entity::Entity(
         type,
         collisionMask
     )),
-    type(type) {
-    if (shape != fixture->GetShape())
-        delete shape;
-}
+    previousPosition(body->GetPosition()),
+    type(type) {}
 
 Entity::Entity(Entity&& e): world(e.world), type(e.type) {
     this->swap(e);
@@ -80,6 +82,103 @@ Vector2 Entity::raylibPosition() const {
     return box2dToRaylib(box2dPosition());
 }
 
+const b2Fixture *Entity::getFixture() const {
+    return fixture;
+}
+
+void Entity::savePreviousPosition() {
+    previousPosition = box2dPosition();
+}
+
+b2Vec2 Entity::interpolatedBox2dPosition(float alpha) const {
+    b2Vec2 current = box2dPosition();
+    return {
+        std::lerp(previousPosition.x, current.x, alpha),
+        std::lerp(previousPosition.y, current.y, alpha)
+    };
+}
+
+Vector2 Entity::interpolatedRaylibPosition(float alpha) const {
+    return box2dToRaylib(interpolatedBox2dPosition(alpha));
+}
+
+b2AABB Entity::sweptBounds(float extent) const {
+    b2Vec2 current = box2dPosition();
+    b2Vec2 margin(extent, extent);
+    b2AABB bounds;
+    bounds.lowerBound = b2Min(previousPosition, current) - margin;
+    bounds.upperBound = b2Max(previousPosition, current) + margin;
+    return bounds;
+}
+
+Entity::BodyState Entity::saveBodyState() const {
+    return {
+        .position = body->GetPosition(),
+        .angle = body->GetAngle(),
+        .linearVelocity = body->GetLinearVelocity(),
+        .angularVelocity = body->GetAngularVelocity(),
+        .enabled = body->IsEnabled(),
+        .awake = body->IsAwake(),
+    };
+}
+
+void Entity::loadBodyState(const BodyState& state) {
+    body->SetEnabled(state.enabled);
+    body->SetTransform(state.position, state.angle);
+    body->SetLinearVelocity(state.linearVelocity);
+    body->SetAngularVelocity(state.angularVelocity);
+    body->SetAwake(state.awake);
+    previousPosition = state.position;
+}
+
+Entity::Blueprint Entity::saveBlueprint() const {
+    Blueprint blueprint;
+    b2BodyDef& bodyDef = blueprint.body;
+    bodyDef.type = body->GetType();
+    bodyDef.position = body->GetPosition();
+    bodyDef.angle = body->GetAngle();
+    bodyDef.linearVelocity = body->GetLinearVelocity();
+    bodyDef.angularVelocity = body->GetAngularVelocity();
+    bodyDef.linearDamping = body->GetLinearDamping();
+    bodyDef.angularDamping = body->GetAngularDamping();
+    bodyDef.allowSleep = body->IsSleepingAllowed();
+    bodyDef.awake = body->IsAwake();
+    bodyDef.fixedRotation = body->IsFixedRotation();
+    bodyDef.bullet = body->IsBullet();
+    bodyDef.enabled = body->IsEnabled();
+    bodyDef.userData = body->GetUserData();
+    bodyDef.gravityScale = body->GetGravityScale();
+
+    b2FixtureDef& fixtureDef = blueprint.fixture;
+    fixtureDef.userData = fixture->GetUserData();
+    fixtureDef.friction = fixture->GetFriction();
+    fixtureDef.restitution = fixture->GetRestitution();
+    fixtureDef.restitutionThreshold = fixture->GetRestitutionThreshold();
+    fixtureDef.density = fixture->GetDensity();
+    fixtureDef.isSensor = fixture->IsSensor();
+    fixtureDef.filter = fixture->GetFilterData();
+
+    const b2Shape *shape = fixture->GetShape();
+    switch (shape->GetType()) {
+    case b2Shape::e_circle:
+        blueprint.shape = *static_cast<const b2CircleShape *>(shape);
+        break;
+    case b2Shape::e_polygon:
+        blueprint.shape = *static_cast<const b2PolygonShape *>(shape);
+        break;
+    default:
+        throw std::logic_error("only circle and polygon fixtures can be rebuilt");
+    }
+    return blueprint;
+}
+
+void Entity::rebuildBody(const Blueprint& blueprint) {
+    body = world.get().CreateBody(&blueprint.body);
+    b2FixtureDef fixtureDef = blueprint.fixture;
+    fixtureDef.shape = std::visit([](const b2Shape& shape) { return &shape; }, blueprint.shape);
+    fixture = body->CreateFixture(&fixtureDef);
+}
+
 Entity *Entity::fromUserDataPointer(uintptr_t pointer) {
     return reinterpret_cast<Entity *>(pointer);
 }
@@ -1,21 +1,20 @@
 #include "explosion.hpp"
 
+#include <bit>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+#include <initializer_list>
 
 #include "world.hpp"
 
-constexpr float lifetime = 1.0f;
 constexpr float initialRadius = 1.0f;
 constexpr float maxRadius = 4.0f;
-constexpr float hitboxRadius = 3.0f;
 constexpr float baseStrength = 600.0f;
 
-
-float explosionExpansionEasing(float t) {
-    t = std::clamp(t, 0.0f, 1.0f);
-    return 1 - std::pow(1 - t, 3);
-}
+// the update loop is unrolled by this many explosions, enough to fill a
+// 256 bit vector register
+constexpr uint32_t updateBlockSize = 8;
 
 float explosionAlphaEasing(float t) {
     if (t == 0) return 0;
@@ -29,42 +28,246 @@ b2Body *constructExplosionBody(b2World& world, b2Vec2 position) {
     return world.CreateBody(&bodyDef);
 }
 
-b2Shape *constructExplosionShape() {
-    b2CircleShape *shape = new b2CircleShape();
-    shape->m_radius = hitboxRadius;
+b2CircleShape constructExplosionShape() {
+    b2CircleShape shape;
+    shape.m_radius = ExplosionSystem::hitboxRadius;
     return shape;
 }
 
-Explosion::Explosion(b2World& world, b2Vec2 position):
+Explosion::Explosion(b2World& world, b2Vec2 position, uint32_t slot):
     Entity(
         world,
         constructExplosionBody(world, position),
         constructExplosionShape(),
         1,
         Entity::EntityType::EXPLOSION,
-        Entity::EntityType::PLAYER | Entity::EntityType::ROCKET
+        ExplosionSystem::collisionMask
     ),
-    timeAliveRatio(0),
-    animRadius(initialRadius) {}
+    slot(slot) {}
+
+uint32_t Explosion::getSlot() const {
+    return slot;
+}
+
+ExplosionSystem::ExplosionSystem(b2World& world, size_t capacity, ExplosionDetection detection):
+    world(world),
+    detection(detection),
+    slotCount(std::bit_ceil(std::max<size_t>(capacity, updateBlockSize))),
+    positionX(slotCount),
+    positionY(slotCount),
+    timeAliveRatio(slotCount),
+    animRadius(slotCount),
+    strength(slotCount),
+    bodies(slotCount) {}
+
+bool ExplosionSystem::spawn(b2Vec2 position) {
+    if (end - first == slotCount) {
+        dropped++;
+        return false;
+    }
+    uint32_t slot = end % slotCount;
+    positionX[slot] = position.x;
+    positionY[slot] = position.y;
+    timeAliveRatio[slot] = 0;
+    animRadius[slot] = initialRadius;
+    strength[slot] = baseStrength / initialRadius;
+    if (detection == ExplosionDetection::SENSOR_BODIES)
+        bodies[slot].emplace(world, position, slot);
+    end++;
+    return true;
+}
+
+uint32_t roundDownToBlock(uint32_t slot) {
+    return slot - slot % updateBlockSize;
+}
+
+uint32_t roundUpToBlock(uint32_t slot) {
+    return roundDownToBlock(slot + updateBlockSize - 1);
+}
+
+// Straight-line float math over packed arrays so the compiler can turn it
+// into vector instructions. Works on whole blocks, so both ends must be
+// multiples of updateBlockSize. Each inner loop only touches one of the
+// arrays, so the compiler doesn't need to prove they don't overlap.
+void ExplosionSystem::updateRange(uint32_t from, uint32_t to, float deltaRatio) {
+    for (size_t block = from; block < to; block += updateBlockSize) {
+        float *timeAlive = &timeAliveRatio[block];
+        float *radius = &animRadius[block];
+        float *str = &strength[block];
+        float t[updateBlockSize];
+        float r[updateBlockSize];
+
+        for (size_t i = 0; i < updateBlockSize; i++) {
+            t[i] = timeAlive[i] + deltaRatio;
+            timeAlive[i] = t[i];
+        }
+        for (size_t i = 0; i < updateBlockSize; i++) {
+            // ease out cubic, unclamped since a comparison here keeps the
+            // compiler from vectorizing, and explosions that go past 1 are
+            // removed before anything reads them
+            float remaining = 1.0f - t[i];
+            float eased = 1.0f - remaining * remaining * remaining;
+            r[i] = initialRadius + (maxRadius - initialRadius) * eased;
+            radius[i] = r[i];
+        }
+        for (size_t i = 0; i < updateBlockSize; i++) {
+            str[i] = baseStrength / r[i];
+        }
+    }
+}
+
+void ExplosionSystem::update(float deltaTime) {
+    if (first == end) return;
+
+    // dead slots sharing a block with live ones get updated too, which is
+    // harmless since they're reset when spawned into
+    float deltaRatio = deltaTime / lifetime;
+    uint32_t firstSlot = first % slotCount;
+    uint32_t lastSlot = (end - 1) % slotCount;
+    uint32_t from = roundDownToBlock(firstSlot);
+    uint32_t to = roundUpToBlock(lastSlot + 1);
+    if (firstSlot <= lastSlot) {
+        updateRange(from, to, deltaRatio);
+    } else if (to > from) {
+        // wrapped around, and both ends share a block
+        updateRange(0, slotCount, deltaRatio);
+    } else {
+        // wrapped around
+        updateRange(from, slotCount, deltaRatio);
+        updateRange(0, to, deltaRatio);
+    }
+
+    uint64_t firstAlive = first;
+    while (firstAlive != end && timeAliveRatio[firstAlive % slotCount] >= 1.0f)
+        firstAlive++;
+    for (uint64_t i = first; i < firstAlive; i++)
+        bodies[i % slotCount].reset();
+    first = firstAlive;
+}
+
+void ExplosionSystem::render(RenderCommandBuffer& commands, const b2AABB *view) const {
+    visibleX.clear();
+    visibleY.clear();
+    visibleRadius.clear();
+    visibleTimeAlive.clear();
+    for (uint64_t i = first; i < end; i++) {
+        uint32_t slot = i % slotCount;
+        float x = positionX[slot];
+        float y = positionY[slot];
+        float radius = animRadius[slot];
+        bool outside = view != nullptr && (
+            x + radius < view->lowerBound.x || x - radius > view->upperBound.x
+            || y + radius < view->lowerBound.y || y - radius > view->upperBound.y
+        );
+        if (outside) continue;
+        visibleX.push_back(x);
+        visibleY.push_back(y);
+        visibleRadius.push_back(radius);
+        visibleTimeAlive.push_back(timeAliveRatio[slot]);
+    }
 
-void Explosion::update(float deltaTime) {
-    timeAliveRatio += deltaTime / lifetime;
-    float easedExpansionTime = explosionExpansionEasing(timeAliveRatio);
-    animRadius = std::lerp(initialRadius, maxRadius, easedExpansionTime);
+    metersToPixels(visibleX);
+    metersToPixels(visibleY);
+    metersToPixels(visibleRadius);
+    for (size_t i = 0; i < visibleX.size(); i++) {
+        Color color = YELLOW;
+        color.a = 255 * (1.0f - explosionAlphaEasing(visibleTimeAlive[i]));
+        commands.circleLines({visibleX[i], visibleY[i]}, visibleRadius[i], color);
+    }
 }
 
-void Explosion::render() const {
-    Vector2 center = raylibPosition();
-    float raylibRadius = metersToPixels(animRadius);
-    Color color = YELLOW;
-    color.a = 255 * (1.0f - explosionAlphaEasing(timeAliveRatio));
-    DrawCircleLinesV(center, raylibRadius, color);
+void ExplosionSystem::clear() {
+    for (uint64_t i = first; i < end; i++)
+        bodies[i % slotCount].reset();
+    first = 0;
+    end = 0;
 }
 
-bool Explosion::isOver() const {
-    return timeAliveRatio >= 1.0f;
+size_t ExplosionSystem::size() const {
+    return end - first;
 }
 
-float Explosion::calculateStrength() const {
-    return baseStrength / animRadius;
+size_t ExplosionSystem::capacity() const {
+    return slotCount;
+}
+
+ExplosionDetection ExplosionSystem::getDetection() const {
+    return detection;
+}
+
+uint64_t ExplosionSystem::droppedCount() const {
+    return dropped;
+}
+
+b2Vec2 ExplosionSystem::positionAt(uint32_t slot) const {
+    return {positionX[slot], positionY[slot]};
+}
+
+float ExplosionSystem::strengthAt(uint32_t slot) const {
+    return strength[slot];
+}
+
+void ExplosionSystem::saveState(ByteWriter& writer) const {
+    writer.put(static_cast<uint32_t>(size()));
+    for (uint64_t i = first; i < end; i++) {
+        uint32_t slot = i % slotCount;
+        writer.put(State{
+            .position = positionAt(slot),
+            .timeAliveRatio = timeAliveRatio[slot],
+            .animRadius = animRadius[slot],
+        });
+    }
+}
+
+void ExplosionSystem::loadState(ByteReader& reader) {
+    clear();
+    auto count = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto state = reader.get<State>();
+        if (!spawn(state.position)) continue;
+        uint32_t slot = (end - 1) % slotCount;
+        timeAliveRatio[slot] = state.timeAliveRatio;
+        animRadius[slot] = state.animRadius;
+        strength[slot] = baseStrength / state.animRadius;
+    }
+}
+
+size_t ExplosionSystem::snapshotSize() const {
+    return 2 * sizeof(uint64_t) + 5 * slotCount * sizeof(float);
+}
+
+void ExplosionSystem::saveSnapshot(uint8_t *out) const {
+    size_t arrayBytes = slotCount * sizeof(float);
+    std::memcpy(out, &first, sizeof(first));
+    std::memcpy(out + sizeof(first), &end, sizeof(end));
+    out += 2 * sizeof(uint64_t);
+    for (const std::vector<float> *array: {&positionX, &positionY, &timeAliveRatio, &animRadius, &strength}) {
+        std::memcpy(out, array->data(), arrayBytes);
+        out += arrayBytes;
+    }
+}
+
+void ExplosionSystem::loadSnapshot(const uint8_t *in) {
+    size_t arrayBytes = slotCount * sizeof(float);
+    // Box2D keeps the contacts of a body that's only moved, and they would
+    // still be touching whatever they touched before the load, so it would
+    // never report them beginning. New bodies have their contacts found
+    // again on the next step.
+    if (detection == ExplosionDetection::SENSOR_BODIES) {
+        for (uint64_t i = first; i < end; i++)
+            bodies[i % slotCount].reset();
+    }
+    std::memcpy(&first, in, sizeof(first));
+    std::memcpy(&end, in + sizeof(first), sizeof(end));
+    in += 2 * sizeof(uint64_t);
+    for (std::vector<float> *array: {&positionX, &positionY, &timeAliveRatio, &animRadius, &strength}) {
+        std::memcpy(array->data(), in, arrayBytes);
+        in += arrayBytes;
+    }
+    if (detection != ExplosionDetection::SENSOR_BODIES) return;
+
+    for (uint64_t i = first; i < end; i++) {
+        uint32_t slot = i % slotCount;
+        bodies[slot].emplace(world, positionAt(slot), slot);
+    }
 }
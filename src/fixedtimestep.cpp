@@ -0,0 +1,26 @@
+#include "fixedtimestep.hpp"
+
+#include <cmath>
+
+FixedTimestep::FixedTimestep(float interval, int maxStepsPerFrame):
+    interval(interval),
+    maxSteps(maxStepsPerFrame) {}
+
+int FixedTimestep::advance(float frameTime) {
+    accumulator += frameTime;
+    int steps = static_cast<int>(accumulator / interval);
+    if (steps > maxSteps) {
+        steps = maxSteps;
+    }
+    accumulator -= steps * interval;
+    // we couldn't catch up, give up on the time we're behind by
+    // instead of trying to make up for it on the next frames
+    if (accumulator >= interval) {
+        accumulator = std::fmod(accumulator, interval);
+    }
+    return steps;
+}
+
+float FixedTimestep::alpha() const {
+    return accumulator / interval;
+}
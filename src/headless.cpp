@@ -0,0 +1,163 @@
+#include "headless.hpp"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <optional>
+
+#include "world.hpp"
+#include "replay.hpp"
+#include "batchsimulation.hpp"
+#include "rollbacksession.hpp"
+
+// keeps players from acting in lockstep
+constexpr uint64_t playerScriptOffset = 7;
+// keeps batched worlds from all playing out the same way
+constexpr uint64_t worldScriptOffset = 13;
+// shoot often enough that the player never has a full magazine
+constexpr uint64_t shootEveryTicks = 20;
+constexpr uint64_t recoilEveryTicks = 240;
+constexpr uint64_t recoilChargeTicks = 90;
+
+TickInput scriptedInput(uint64_t tick) {
+    TickInput input;
+    // alternate between the wall below the player and a point in the air
+    // so rockets explode both by collision and by age
+    input.target = (tick / shootEveryTicks) % 2 == 0
+        ? b2Vec2{-5.0f, 12.0f}
+        : b2Vec2{8.0f, -6.0f};
+    input.leftPressed = tick % shootEveryTicks == 0;
+    input.rightPressed = tick % recoilEveryTicks == 0;
+    input.rightReleased = tick % recoilEveryTicks == recoilChargeTicks;
+    return input;
+}
+
+void reportTicksPerSecond(uint64_t ticks, std::chrono::duration<double> elapsed) {
+    std::cout << "ticks: " << ticks << std::endl;
+    std::cout << "elapsed: " << elapsed.count() << "s" << std::endl;
+    std::cout << "ticks/sec: " << static_cast<double>(ticks) / elapsed.count() << std::endl;
+}
+
+int runHeadless(uint64_t ticks, std::string_view recordPath, SimulationOptions options) {
+    Simulation simulation(1, options);
+    std::optional<ReplayWriter> recorder;
+    if (!recordPath.empty())
+        recorder.emplace(recordPath, simulation);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ticks; i++) {
+        for (size_t player = 0; player < simulation.playerCount(); player++) {
+            TickInput input = scriptedInput(simulation.tick() + player * playerScriptOffset);
+            simulation.applyInput(player, input);
+            if (recorder) recorder->recordInput(simulation, player, input);
+        }
+        simulation.step();
+        if (recorder) recorder->afterStep(simulation);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    reportTicksPerSecond(ticks, elapsed);
+    return 0;
+}
+
+int runBatch(size_t worldCount, uint64_t ticks, SimulationOptions options) {
+    BatchSimulation batch(worldCount, 1, options);
+    std::cout << "worlds: " << batch.size() << ", threads: " << batch.threadCount() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    batch.run(ticks, [](size_t worldIndex, Simulation& simulation) {
+        uint64_t scriptTick = simulation.tick() + worldIndex * worldScriptOffset;
+        for (size_t player = 0; player < simulation.playerCount(); player++)
+            simulation.applyInput(player, scriptedInput(scriptTick + player * playerScriptOffset));
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    reportTicksPerSecond(ticks * batch.size(), elapsed);
+    return 0;
+}
+
+int runRenderStats(const Level& level, int frames, const b2AABB& view, SimulationOptions options) {
+    for (auto [culling, caching]: {std::pair{false, false}, {true, false}, {false, true}, {true, true}}) {
+        WallLayer::setCachingEnabled(caching);
+        Simulation simulation(1, options, level);
+        RenderCommandBuffer commands;
+        uint64_t recorded = 0;
+        std::chrono::duration<double> elapsed = {};
+        for (int i = 0; i < frames; i++) {
+            simulation.applyInput(0, scriptedInput(simulation.tick()));
+            simulation.step();
+
+            auto start = std::chrono::steady_clock::now();
+            commands.clear();
+            simulation.render(commands, 1.0f, culling ? &view : nullptr);
+            commands.sort();
+            elapsed += std::chrono::steady_clock::now() - start;
+            recorded += commands.size();
+        }
+        std::cout << (culling ? "culled, " : "unculled, ") << (caching ? "cached walls" : "immediate walls")
+            << ": commands/frame: " << static_cast<double>(recorded) / frames
+            << ", wall outlines in the last frame: " << commands.count(RenderCommand::Type::RECTANGLE_LINES)
+            << ", us/frame: " << elapsed.count() * 1e6 / frames << std::endl;
+    }
+    WallLayer::setCachingEnabled(true);
+    return 0;
+}
+
+int runRollback(uint64_t ticks, LoopbackOptions network, SimulationOptions options) {
+    LoopbackLink link(network);
+    // deques since sessions refer to their simulation
+    std::deque<Simulation> simulations;
+    std::deque<RollbackSession> sessions;
+    for (size_t peer = 0; peer < 2; peer++) {
+        simulations.emplace_back(2, options);
+        sessions.emplace_back(simulations.back(), peer, link.endpoint(peer));
+    }
+
+    uint64_t frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (simulations[0].tick() < ticks || simulations[1].tick() < ticks) {
+        for (size_t peer = 0; peer < 2; peer++) {
+            if (simulations[peer].tick() >= ticks) continue;
+            // each peer sees its own player's script, the other one only through the link
+            TickInput input = scriptedInput(simulations[peer].tick() + peer * playerScriptOffset);
+            sessions[peer].advance(input);
+        }
+        link.advance(SIMULATION_STEP_INTERVAL);
+        frames++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    reportTicksPerSecond(2 * ticks, elapsed);
+    std::cout << "frames: " << frames << std::endl;
+    bool desynced = false;
+    for (size_t peer = 0; peer < 2; peer++) {
+        const RollbackSession::Stats& stats = sessions[peer].getStats();
+        std::cout << "peer " << peer
+            << ": rollbacks " << stats.rollbacks
+            << ", resimulated ticks " << stats.resimulatedTicks
+            << ", deepest rollback " << stats.maxRollbackDepth
+            << ", stalls " << stats.stalls << std::endl;
+        if (auto tick = sessions[peer].desyncTick()) {
+            std::cout << "peer " << peer << ": desync at tick " << *tick << std::endl;
+            desynced = true;
+        }
+    }
+    return desynced ? 1 : 0;
+}
+
+int runReplay(std::string_view path, uint64_t fromTick) {
+    ReplayReader replay(path);
+    Simulation simulation(replay.playerCount(), replay.getSimulationOptions(), replay.loadRecordedLevel());
+    replay.seek(simulation, fromTick);
+
+    uint64_t firstTick = simulation.tick();
+    auto start = std::chrono::steady_clock::now();
+    while (simulation.tick() < replay.length()) {
+        replay.applyInputs(simulation);
+        simulation.step();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    reportTicksPerSecond(simulation.tick() - firstTick, elapsed);
+    return 0;
+}
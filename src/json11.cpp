@@ -20,11 +20,20 @@
  */
 
 #include "json11.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
+#include <bit>
+#include <charconv>
+#include <iterator>
 #include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace json11 {
 
@@ -32,7 +41,6 @@ static const int max_depth = 200;
 
 using std::string;
 using std::vector;
-using std::map;
 using std::make_shared;
 using std::initializer_list;
 using std::move;
@@ -231,7 +239,7 @@ struct Statics {
     const std::shared_ptr<JsonValue> f = make_shared<JsonBoolean>(false);
     const string empty_string;
     const vector<Json> empty_vector;
-    const map<string, Json> empty_map;
+    const Json::object empty_map;
     Statics() {}
 };
 
@@ -273,7 +281,7 @@ int Json::int_value()                             const { return m_ptr->int_valu
 bool Json::bool_value()                           const { return m_ptr->bool_value();   }
 const string & Json::string_value()               const { return m_ptr->string_value(); }
 const vector<Json> & Json::array_items()          const { return m_ptr->array_items();  }
-const map<string, Json> & Json::object_items()    const { return m_ptr->object_items(); }
+const Json::object & Json::object_items()         const { return m_ptr->object_items(); }
 const Json & Json::operator[] (size_t i)          const { return (*m_ptr)[i];           }
 const Json & Json::operator[] (const string &key) const { return (*m_ptr)[key];         }
 
@@ -282,10 +290,159 @@ int                       JsonValue::int_value()                 const { return
 bool                      JsonValue::bool_value()                const { return false; }
 const string &            JsonValue::string_value()              const { return statics().empty_string; }
 const vector<Json> &      JsonValue::array_items()               const { return statics().empty_vector; }
-const map<string, Json> & JsonValue::object_items()              const { return statics().empty_map; }
+const Json::object &      JsonValue::object_items()              const { return statics().empty_map; }
 const Json &              JsonValue::operator[] (size_t)         const { return static_null(); }
 const Json &              JsonValue::operator[] (const string &) const { return static_null(); }
 
+/* * * * * * * * * * * * * * * * * * * *
+ * JsonMap
+ */
+
+static bool key_less(const Json::object::value_type &a, const Json::object::value_type &b) {
+    return a.first < b.first;
+}
+
+static bool key_not_less(const Json::object::value_type &a, const Json::object::value_type &b) {
+    return !(a.first < b.first);
+}
+
+static bool key_equal(const Json::object::value_type &a, const Json::object::value_type &b) {
+    return a.first == b.first;
+}
+
+/* object_from_members(members)
+ *
+ * Make an object from members in the order they were parsed, keeping the last of repeated
+ * keys as if each had been assigned in turn. Objects usually come with unique keys, often
+ * sorted, which is checked first.
+ */
+static Json::object object_from_members(vector<Json::object::value_type> &&members) {
+    if (std::adjacent_find(members.begin(), members.end(), key_not_less) != members.end()) {
+        std::stable_sort(members.begin(), members.end(), key_less);
+        auto last = std::unique(members.rbegin(), members.rend(), key_equal);
+        members.erase(members.begin(), last.base());
+    }
+    return Json::object(std::make_move_iterator(members.begin()),
+                        std::make_move_iterator(members.end()));
+}
+
+JsonMap::JsonMap() noexcept {}
+JsonMap::JsonMap(initializer_list<value_type> members)
+    : JsonMap(members.begin(), members.end()) {}
+
+JsonMap::iterator JsonMap::begin() noexcept                     { return m_members.begin(); }
+JsonMap::iterator JsonMap::end() noexcept                       { return m_members.end(); }
+JsonMap::const_iterator JsonMap::begin() const noexcept         { return m_members.begin(); }
+JsonMap::const_iterator JsonMap::end() const noexcept           { return m_members.end(); }
+JsonMap::const_iterator JsonMap::cbegin() const noexcept        { return m_members.cbegin(); }
+JsonMap::const_iterator JsonMap::cend() const noexcept          { return m_members.cend(); }
+
+bool JsonMap::empty() const noexcept                            { return m_members.empty(); }
+JsonMap::size_type JsonMap::size() const noexcept               { return m_members.size(); }
+void JsonMap::clear() noexcept                                  { m_members.clear(); }
+void JsonMap::reserve(size_type count)                          { m_members.reserve(count); }
+
+void JsonMap::sort_members() {
+    if (std::adjacent_find(m_members.begin(), m_members.end(), key_not_less) == m_members.end())
+        return;
+    std::stable_sort(m_members.begin(), m_members.end(), key_less);
+    m_members.erase(std::unique(m_members.begin(), m_members.end(), key_equal), m_members.end());
+}
+
+JsonMap::iterator JsonMap::lower_bound(std::string_view key) {
+    return std::lower_bound(m_members.begin(), m_members.end(), key,
+        [](const value_type &member, std::string_view key) { return member.first < key; });
+}
+
+JsonMap::const_iterator JsonMap::lower_bound(std::string_view key) const {
+    return std::lower_bound(m_members.begin(), m_members.end(), key,
+        [](const value_type &member, std::string_view key) { return member.first < key; });
+}
+
+JsonMap::iterator JsonMap::find(std::string_view key) {
+    auto it = lower_bound(key);
+    return (it != m_members.end() && it->first == key) ? it : m_members.end();
+}
+
+JsonMap::const_iterator JsonMap::find(std::string_view key) const {
+    auto it = lower_bound(key);
+    return (it != m_members.end() && it->first == key) ? it : m_members.end();
+}
+
+JsonMap::size_type JsonMap::count(std::string_view key) const {
+    return find(key) != m_members.end() ? 1 : 0;
+}
+
+bool JsonMap::contains(std::string_view key) const {
+    return find(key) != m_members.end();
+}
+
+Json &JsonMap::operator[](const string &key) {
+    auto it = lower_bound(key);
+    if (it == m_members.end() || it->first != key)
+        it = m_members.emplace(it, key, Json());
+    return it->second;
+}
+
+Json &JsonMap::operator[](string &&key) {
+    auto it = lower_bound(key);
+    if (it == m_members.end() || it->first != key)
+        it = m_members.emplace(it, move(key), Json());
+    return it->second;
+}
+
+Json &JsonMap::at(std::string_view key) {
+    auto it = find(key);
+    if (it == m_members.end())
+        throw std::out_of_range("JsonMap::at");
+    return it->second;
+}
+
+const Json &JsonMap::at(std::string_view key) const {
+    auto it = find(key);
+    if (it == m_members.end())
+        throw std::out_of_range("JsonMap::at");
+    return it->second;
+}
+
+std::pair<JsonMap::iterator, bool> JsonMap::insert(const value_type &member) {
+    auto it = lower_bound(member.first);
+    if (it != m_members.end() && it->first == member.first)
+        return { it, false };
+    return { m_members.insert(it, member), true };
+}
+
+std::pair<JsonMap::iterator, bool> JsonMap::insert(value_type &&member) {
+    auto it = lower_bound(member.first);
+    if (it != m_members.end() && it->first == member.first)
+        return { it, false };
+    return { m_members.insert(it, move(member)), true };
+}
+
+std::pair<JsonMap::iterator, bool> JsonMap::emplace(string key, Json value) {
+    return insert(value_type(move(key), move(value)));
+}
+
+JsonMap::size_type JsonMap::erase(std::string_view key) {
+    auto it = find(key);
+    if (it == m_members.end())
+        return 0;
+    m_members.erase(it);
+    return 1;
+}
+
+JsonMap::iterator JsonMap::erase(const_iterator pos) {
+    return m_members.erase(pos);
+}
+
+bool JsonMap::operator==(const JsonMap &rhs) const {
+    return m_members == rhs.m_members;
+}
+
+bool JsonMap::operator<(const JsonMap &rhs) const {
+    return m_members < rhs.m_members;
+}
+
 const Json & JsonObject::operator[] (const string &key) const {
     auto iter = m_value.find(key);
     return (iter == m_value.end()) ? static_null() : iter->second;
@@ -339,6 +496,108 @@ static inline bool in_range(long x, long lower, long upper) {
     return (x >= lower && x <= upper);
 }
 
+/* * * * * * * * * * * * * * * * * * * *
+ * Scanning
+ *
+ * Skipping whitespace and finding the end of a run of plain string characters are where the
+ * parser spends most of its time. Both are done a block at a time with AVX2 (when the build
+ * enables it) and SSE2 (every x86-64), then a char at a time for the rest of the input, and
+ * everywhere else. Blocks are only loaded when they fit before the end of the input.
+ */
+
+static inline bool is_whitespace(char c) {
+    return c == ' ' || c == '\r' || c == '\n' || c == '\t';
+}
+
+static inline bool is_string_special(char c) {
+    return c == '"' || c == '\\' || in_range(c, 0, 0x1f);
+}
+
+/* skip_whitespace(str, i)
+ *
+ * Return the position of the first non-whitespace character at or after i, or str.size().
+ */
+static size_t skip_whitespace(std::string_view str, size_t i) {
+    const char *p = str.data() + i;
+    const char *end = str.data() + str.size();
+#if defined(__AVX2__)
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\r'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n')),
+                            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\t'))));
+        uint32_t other = ~static_cast<uint32_t>(_mm256_movemask_epi8(whitespace));
+        if (other != 0)
+            return (p - str.data()) + std::countr_zero(other);
+        p += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')),
+                         _mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))),
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')),
+                         _mm_cmpeq_epi8(block, _mm_set1_epi8('\t'))));
+        uint32_t other = ~static_cast<uint32_t>(_mm_movemask_epi8(whitespace)) & 0xFFFF;
+        if (other != 0)
+            return (p - str.data()) + std::countr_zero(other);
+        p += 16;
+    }
+#endif
+    while (p < end && is_whitespace(*p))
+        p++;
+    return p - str.data();
+}
+
+/* find_string_special(str, i)
+ *
+ * Return the position of the first quote, backslash or control character at or after i, or
+ * str.size(). Everything before it is copied as it is into a string.
+ */
+static size_t find_string_special(std::string_view str, size_t i) {
+    const char *p = str.data() + i;
+    const char *end = str.data() + str.size();
+#if defined(__AVX2__)
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        // unsigned block <= 0x1f
+        __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(block, _mm256_set1_epi8(0x1f)),
+                                            _mm256_set1_epi8(0x1f));
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('"')),
+                            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\\'))),
+            control);
+        uint32_t found = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+        if (found != 0)
+            return (p - str.data()) + std::countr_zero(found);
+        p += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        // unsigned block <= 0x1f
+        __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(block, _mm_set1_epi8(0x1f)),
+                                         _mm_set1_epi8(0x1f));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+                         _mm_cmpeq_epi8(block, _mm_set1_epi8('\\'))),
+            control);
+        uint32_t found = static_cast<uint32_t>(_mm_movemask_epi8(special));
+        if (found != 0)
+            return (p - str.data()) + std::countr_zero(found);
+        p += 16;
+    }
+#endif
+    while (p < end && !is_string_special(*p))
+        p++;
+    return p - str.data();
+}
+
 namespace {
 /* JsonParser
  *
@@ -348,7 +607,7 @@ struct JsonParser final {
 
     /* State
      */
-    const string &str;
+    std::string_view str;
     size_t i;
     string &err;
     bool failed;
@@ -370,13 +629,27 @@ struct JsonParser final {
         return err_ret;
     }
 
+    /* at(pos)
+     *
+     * Return the character at pos, or 0 past the end of the input, which isn't necessarily
+     * NUL-terminated.
+     */
+    char at(size_t pos) const {
+        return pos < str.size() ? str[pos] : static_cast<char>(0);
+    }
+
     /* consume_whitespace()
      *
      * Advance until the current character is non-whitespace.
      */
     void consume_whitespace() {
-        while (str[i] == ' ' || str[i] == '\r' || str[i] == '\n' || str[i] == '\t')
-            i++;
+        // most tokens are followed by no whitespace or a single space, too little for a
+        // block scan to pay off
+        if (!is_whitespace(at(i)))
+            return;
+        if (!is_whitespace(at(++i)))
+            return;
+        i = skip_whitespace(str, i + 1);
     }
 
     /* consume_comment()
@@ -385,7 +658,7 @@ struct JsonParser final {
      */
     bool consume_comment() {
       bool comment_found = false;
-      if (str[i] == '/') {
+      if (at(i) == '/') {
         i++;
         if (i == str.size())
           return fail("unexpected end of input after start of comment", false);
@@ -452,24 +725,25 @@ struct JsonParser final {
      *
      * Encode pt as UTF-8 and add it to out.
      */
-    void encode_utf8(long pt, string & out) {
+    template <typename Out>
+    void encode_utf8(long pt, Out & out) {
         if (pt < 0)
             return;
 
         if (pt < 0x80) {
-            out += static_cast<char>(pt);
+            out.push_back(static_cast<char>(pt));
         } else if (pt < 0x800) {
-            out += static_cast<char>((pt >> 6) | 0xC0);
-            out += static_cast<char>((pt & 0x3F) | 0x80);
+            out.push_back(static_cast<char>((pt >> 6) | 0xC0));
+            out.push_back(static_cast<char>((pt & 0x3F) | 0x80));
         } else if (pt < 0x10000) {
-            out += static_cast<char>((pt >> 12) | 0xE0);
-            out += static_cast<char>(((pt >> 6) & 0x3F) | 0x80);
-            out += static_cast<char>((pt & 0x3F) | 0x80);
+            out.push_back(static_cast<char>((pt >> 12) | 0xE0));
+            out.push_back(static_cast<char>(((pt >> 6) & 0x3F) | 0x80));
+            out.push_back(static_cast<char>((pt & 0x3F) | 0x80));
         } else {
-            out += static_cast<char>((pt >> 18) | 0xF0);
-            out += static_cast<char>(((pt >> 12) & 0x3F) | 0x80);
-            out += static_cast<char>(((pt >> 6) & 0x3F) | 0x80);
-            out += static_cast<char>((pt & 0x3F) | 0x80);
+            out.push_back(static_cast<char>((pt >> 18) | 0xF0));
+            out.push_back(static_cast<char>(((pt >> 12) & 0x3F) | 0x80));
+            out.push_back(static_cast<char>(((pt >> 6) & 0x3F) | 0x80));
+            out.push_back(static_cast<char>((pt & 0x3F) | 0x80));
         }
     }
 
@@ -479,48 +753,61 @@ struct JsonParser final {
      */
     string parse_string() {
         string out;
+        if (!parse_string_into(out))
+            return "";
+        return out;
+    }
+
+    /* parse_string_into(out)
+     *
+     * Parse a string, starting at the current position, and append it to out, a std::string
+     * or std::vector<char>. Return false if it fails.
+     */
+    template <typename Out>
+    bool parse_string_into(Out & out) {
         long last_escaped_codepoint = -1;
         while (true) {
+            // The usual case: a run of non-escaped characters, copied together
+            size_t run_end = find_string_special(str, i);
+            if (run_end != i) {
+                encode_utf8(last_escaped_codepoint, out);
+                last_escaped_codepoint = -1;
+                out.insert(out.end(), str.data() + i, str.data() + run_end);
+                i = run_end;
+            }
+
             if (i == str.size())
-                return fail("unexpected end of input in string", "");
+                return fail("unexpected end of input in string", false);
 
             char ch = str[i++];
 
             if (ch == '"') {
                 encode_utf8(last_escaped_codepoint, out);
-                return out;
+                return true;
             }
 
             if (in_range(ch, 0, 0x1f))
-                return fail("unescaped " + esc(ch) + " in string", "");
-
-            // The usual case: non-escaped characters
-            if (ch != '\\') {
-                encode_utf8(last_escaped_codepoint, out);
-                last_escaped_codepoint = -1;
-                out += ch;
-                continue;
-            }
+                return fail("unescaped " + esc(ch) + " in string", false);
 
             // Handle escapes
             if (i == str.size())
-                return fail("unexpected end of input in string", "");
+                return fail("unexpected end of input in string", false);
 
             ch = str[i++];
 
             if (ch == 'u') {
                 // Extract 4-byte escape sequence
-                string esc = str.substr(i, 4);
+                string esc(str.substr(i, 4));
                 // Explicitly check length of the substring. The following loop
                 // relies on std::string returning the terminating NUL when
                 // accessing str[length]. Checking here reduces brittleness.
                 if (esc.length() < 4) {
-                    return fail("bad \\u escape: " + esc, "");
+                    return fail("bad \\u escape: " + esc, false);
                 }
                 for (size_t j = 0; j < 4; j++) {
                     if (!in_range(esc[j], 'a', 'f') && !in_range(esc[j], 'A', 'F')
                             && !in_range(esc[j], '0', '9'))
-                        return fail("bad \\u escape: " + esc, "");
+                        return fail("bad \\u escape: " + esc, false);
                 }
 
                 long codepoint = strtol(esc.data(), nullptr, 16);
@@ -549,19 +836,19 @@ struct JsonParser final {
             last_escaped_codepoint = -1;
 
             if (ch == 'b') {
-                out += '\b';
+                out.push_back('\b');
             } else if (ch == 'f') {
-                out += '\f';
+                out.push_back('\f');
             } else if (ch == 'n') {
-                out += '\n';
+                out.push_back('\n');
             } else if (ch == 'r') {
-                out += '\r';
+                out.push_back('\r');
             } else if (ch == 't') {
-                out += '\t';
+                out.push_back('\t');
             } else if (ch == '"' || ch == '\\' || ch == '/') {
-                out += ch;
+                out.push_back(ch);
             } else {
-                return fail("invalid escape character " + esc(ch), "");
+                return fail("invalid escape character " + esc(ch), false);
             }
         }
     }
@@ -571,54 +858,79 @@ struct JsonParser final {
      * Parse a double.
      */
     Json parse_number() {
+        double value;
+        bool is_int;
+        if (!parse_number_into(value, is_int))
+            return Json();
+        if (is_int)
+            return static_cast<int>(value);
+        return value;
+    }
+
+    /* parse_number_into(value, is_int)
+     *
+     * Parse a double into value, setting is_int if it was read as an int. Return false if
+     * it fails.
+     */
+    bool parse_number_into(double &value, bool &is_int) {
         size_t start_pos = i;
+        is_int = false;
 
-        if (str[i] == '-')
+        if (at(i) == '-')
             i++;
 
         // Integer part
-        if (str[i] == '0') {
+        if (at(i) == '0') {
             i++;
-            if (in_range(str[i], '0', '9'))
-                return fail("leading 0s not permitted in numbers");
-        } else if (in_range(str[i], '1', '9')) {
+            if (in_range(at(i), '0', '9'))
+                return fail("leading 0s not permitted in numbers", false);
+        } else if (in_range(at(i), '1', '9')) {
             i++;
-            while (in_range(str[i], '0', '9'))
+            while (in_range(at(i), '0', '9'))
                 i++;
         } else {
-            return fail("invalid " + esc(str[i]) + " in number");
+            return fail("invalid " + esc(at(i)) + " in number", false);
         }
 
-        if (str[i] != '.' && str[i] != 'e' && str[i] != 'E'
+        if (at(i) != '.' && at(i) != 'e' && at(i) != 'E'
                 && (i - start_pos) <= static_cast<size_t>(std::numeric_limits<int>::digits10)) {
-            return std::atoi(str.c_str() + start_pos);
+            int int_value = 0;
+            std::from_chars(str.data() + start_pos, str.data() + i, int_value);
+            is_int = true;
+            value = int_value;
+            return true;
         }
 
         // Decimal part
-        if (str[i] == '.') {
+        if (at(i) == '.') {
             i++;
-            if (!in_range(str[i], '0', '9'))
-                return fail("at least one digit required in fractional part");
+            if (!in_range(at(i), '0', '9'))
+                return fail("at least one digit required in fractional part", false);
 
-            while (in_range(str[i], '0', '9'))
+            while (in_range(at(i), '0', '9'))
                 i++;
         }
 
         // Exponent part
-        if (str[i] == 'e' || str[i] == 'E') {
+        if (at(i) == 'e' || at(i) == 'E') {
             i++;
 
-            if (str[i] == '+' || str[i] == '-')
+            if (at(i) == '+' || at(i) == '-')
                 i++;
 
-            if (!in_range(str[i], '0', '9'))
-                return fail("at least one digit required in exponent");
+            if (!in_range(at(i), '0', '9'))
+                return fail("at least one digit required in exponent", false);
 
-            while (in_range(str[i], '0', '9'))
+            while (in_range(at(i), '0', '9'))
                 i++;
         }
 
-        return std::strtod(str.c_str() + start_pos, nullptr);
+        // from_chars doesn't need the NUL that strtod does, but leaves value alone instead
+        // of rounding to infinity or zero when it is out of range
+        auto result = std::from_chars(str.data() + start_pos, str.data() + i, value);
+        if (result.ec == std::errc::result_out_of_range)
+            value = std::strtod(string(str.substr(start_pos, i - start_pos)).c_str(), nullptr);
+        return true;
     }
 
     /* expect(str, res)
@@ -627,13 +939,24 @@ struct JsonParser final {
      * the input and return res. If not, flag an error.
      */
     Json expect(const string &expected, Json res) {
+        if (!match(expected))
+            return Json();
+        return res;
+    }
+
+    /* match(str)
+     *
+     * Like expect(), but return whether 'str' was there.
+     */
+    bool match(const string &expected) {
         assert(i != 0);
         i--;
         if (str.compare(i, expected.length(), expected) == 0) {
             i += expected.length();
-            return res;
+            return true;
         } else {
-            return fail("parse error: expected " + expected + ", got " + str.substr(i, expected.length()));
+            return fail("parse error: expected " + expected + ", got "
+                        + string(str.substr(i, expected.length())), false);
         }
     }
 
@@ -668,10 +991,10 @@ struct JsonParser final {
             return parse_string();
 
         if (ch == '{') {
-            map<string, Json> data;
+            vector<Json::object::value_type> data;
             ch = get_next_token();
             if (ch == '}')
-                return data;
+                return Json::object();
 
             while (1) {
                 if (ch != '"')
@@ -685,7 +1008,7 @@ struct JsonParser final {
                 if (ch != ':')
                     return fail("expected ':' in object, got " + esc(ch));
 
-                data[std::move(key)] = parse_json(depth + 1);
+                data.emplace_back(std::move(key), parse_json(depth + 1));
                 if (failed)
                     return Json();
 
@@ -697,7 +1020,7 @@ struct JsonParser final {
 
                 ch = get_next_token();
             }
-            return data;
+            return object_from_members(move(data));
         }
 
         if (ch == '[') {
@@ -727,9 +1050,201 @@ struct JsonParser final {
         return fail("expected value, got " + esc(ch));
     }
 };
+
+/* DocumentBuilder
+ *
+ * Parses the same grammar as JsonParser::parse_json, with its lexing, into the arena of a
+ * JsonDocument. Every value parsed is pushed onto a scratch stack, and when an array or
+ * object ends, its items are moved from the stack to the arena together so they stay
+ * contiguous. Until finish(), containers hold the index of their first child and decoded
+ * strings their offset, since the arena may still move.
+ */
+struct DocumentBuilder final {
+
+    /* State
+     */
+    JsonParser &parser;
+    vector<JsonNode> &nodes;
+    vector<char> &strings;
+    vector<JsonNode> stack;
+
+    /* push_string()
+     *
+     * Parse a string, starting at the current position. Strings without escapes are left in
+     * the input, others are decoded into the arena.
+     */
+    bool push_string() {
+        size_t end = find_string_special(parser.str, parser.i);
+        if (end < parser.str.size() && parser.str[end] == '"')
+            return push_input_string(end);
+
+        size_t start = strings.size();
+        if (!parser.parse_string_into(strings))
+            return false;
+        size_t length = strings.size() - start;
+        if (length > std::numeric_limits<uint32_t>::max())
+            return parser.fail("string too long", false);
+
+        JsonNode node {};
+        node.type = Json::STRING;
+        node.length = static_cast<uint32_t>(length);
+        node.offset = start;
+        stack.push_back(node);
+        return true;
+    }
+
+    /* push_input_string(end)
+     *
+     * Push the string from the current position to the closing quote at end, as it is in
+     * the input.
+     */
+    bool push_input_string(size_t end) {
+        size_t length = end - parser.i;
+        if (length > std::numeric_limits<uint32_t>::max())
+            return parser.fail("string too long", false);
+
+        JsonNode node {};
+        node.type = Json::STRING;
+        node.in_input = true;
+        node.length = static_cast<uint32_t>(length);
+        node.chars = parser.str.data() + parser.i;
+        stack.push_back(node);
+        parser.i = end + 1;
+        return true;
+    }
+
+    /* close(type, first)
+     *
+     * Move the items of the array or object that started at stack[first] to the arena, and
+     * push the container in their place.
+     */
+    bool close(Json::Type type, size_t first) {
+        size_t length = stack.size() - first;
+        if (type == Json::OBJECT)
+            length /= 2;
+        if (length > std::numeric_limits<uint32_t>::max())
+            return parser.fail("too many items", false);
+
+        JsonNode node {};
+        node.type = type;
+        node.length = static_cast<uint32_t>(length);
+        node.children = nodes.size();
+        nodes.insert(nodes.end(), stack.begin() + first, stack.end());
+        stack.resize(first);
+        stack.push_back(node);
+        return true;
+    }
+
+    /* parse_node()
+     *
+     * Parse a JSON value, pushing exactly one node onto the stack if it succeeds.
+     */
+    bool parse_node(int depth) {
+        if (depth > max_depth) {
+            return parser.fail("exceeded maximum nesting depth", false);
+        }
+
+        char ch = parser.get_next_token();
+        if (parser.failed)
+            return false;
+
+        JsonNode node {};
+
+        if (ch == '-' || (ch >= '0' && ch <= '9')) {
+            parser.i--;
+            bool is_int;
+            node.type = Json::NUMBER;
+            if (!parser.parse_number_into(node.number, is_int))
+                return false;
+        } else if (ch == 't' || ch == 'f') {
+            node.type = Json::BOOL;
+            node.bool_value = ch == 't';
+            if (!parser.match(node.bool_value ? "true" : "false"))
+                return false;
+        } else if (ch == 'n') {
+            node.type = Json::NUL;
+            if (!parser.match("null"))
+                return false;
+        } else if (ch == '"') {
+            return push_string();
+        } else if (ch == '{') {
+            size_t first = stack.size();
+            ch = parser.get_next_token();
+            if (ch == '}')
+                return close(Json::OBJECT, first);
+
+            while (1) {
+                if (ch != '"')
+                    return parser.fail("expected '\"' in object, got " + esc(ch), false);
+
+                if (!push_string())
+                    return false;
+
+                ch = parser.get_next_token();
+                if (ch != ':')
+                    return parser.fail("expected ':' in object, got " + esc(ch), false);
+
+                if (!parse_node(depth + 1))
+                    return false;
+
+                ch = parser.get_next_token();
+                if (ch == '}')
+                    break;
+                if (ch != ',')
+                    return parser.fail("expected ',' in object, got " + esc(ch), false);
+
+                ch = parser.get_next_token();
+            }
+            return close(Json::OBJECT, first);
+        } else if (ch == '[') {
+            size_t first = stack.size();
+            ch = parser.get_next_token();
+            if (ch == ']')
+                return close(Json::ARRAY, first);
+
+            while (1) {
+                parser.i--;
+                if (!parse_node(depth + 1))
+                    return false;
+
+                ch = parser.get_next_token();
+                if (ch == ']')
+                    break;
+                if (ch != ',')
+                    return parser.fail("expected ',' in list, got " + esc(ch), false);
+
+                ch = parser.get_next_token();
+                (void)ch;
+            }
+            return close(Json::ARRAY, first);
+        } else {
+            return parser.fail("expected value, got " + esc(ch), false);
+        }
+
+        stack.push_back(node);
+        return true;
+    }
+
+    /* finish()
+     *
+     * Move the root to the arena and give every decoded string and container its final
+     * address, once nothing more will be added.
+     */
+    void finish() {
+        nodes.push_back(stack.back());
+        stack.clear();
+        for (size_t k = 0; k < nodes.size(); k++) {
+            JsonNode &node = nodes[k];
+            if (node.type == Json::STRING && !node.in_input)
+                node.chars = strings.data() + node.offset;
+            else if (node.type == Json::ARRAY || node.type == Json::OBJECT)
+                node.children = k - node.children;
+        }
+    }
+};
 }//namespace {
 
-Json Json::parse(const string &in, string &err, JsonParse strategy) {
+Json Json::parse(std::string_view in, string &err, JsonParse strategy) {
     JsonParser parser { in, 0, err, false, strategy };
     Json result = parser.parse_json(0);
 
@@ -744,7 +1259,7 @@ Json Json::parse(const string &in, string &err, JsonParse strategy) {
 }
 
 // Documented in json11.hpp
-vector<Json> Json::parse_multi(const string &in,
+vector<Json> Json::parse_multi(std::string_view in,
                                std::string::size_type &parser_stop_pos,
                                string &err,
                                JsonParse strategy) {
@@ -765,6 +1280,458 @@ vector<Json> Json::parse_multi(const string &in,
     return json_vec;
 }
 
+/* * * * * * * * * * * * * * * * * * * *
+ * Documents
+ */
+
+JsonDocument JsonDocument::parse(std::string_view in, string &err, JsonParse strategy) {
+    JsonDocument document;
+    JsonParser parser { in, 0, err, false, strategy };
+    DocumentBuilder builder { parser, document.m_nodes, document.m_strings, {} };
+    builder.parse_node(0);
+
+    // Check for any trailing garbage
+    parser.consume_garbage();
+    if (parser.failed)
+        return JsonDocument();
+    if (parser.i != in.size()) {
+        parser.fail("unexpected trailing " + esc(in[parser.i]));
+        return JsonDocument();
+    }
+
+    builder.finish();
+    return document;
+}
+
+JsonView JsonDocument::root() const {
+    if (m_nodes.empty())
+        return JsonView();
+    return JsonView(&m_nodes.back());
+}
+
+size_t JsonDocument::arena_size() const {
+    return m_nodes.capacity() * sizeof(JsonNode) + m_strings.capacity();
+}
+
+Json::Type JsonView::type() const {
+    return m_node ? static_cast<Json::Type>(m_node->type) : Json::NUL;
+}
+
+double JsonView::number_value() const {
+    return is_number() ? m_node->number : 0;
+}
+
+int JsonView::int_value() const {
+    return static_cast<int>(number_value());
+}
+
+bool JsonView::bool_value() const {
+    return is_bool() ? m_node->bool_value : false;
+}
+
+std::string_view JsonView::string_value() const {
+    if (!is_string())
+        return std::string_view();
+    return std::string_view(m_node->chars, m_node->length);
+}
+
+size_t JsonView::size() const {
+    return is_array() || is_object() ? m_node->length : 0;
+}
+
+JsonView JsonView::operator[](size_t i) const {
+    if (!is_array() || i >= m_node->length)
+        return JsonView();
+    return JsonView(m_node - m_node->children + i);
+}
+
+JsonView JsonView::operator[](std::string_view key) const {
+    if (!is_object())
+        return JsonView();
+    const JsonNode *members = m_node - m_node->children;
+    for (size_t i = m_node->length; i-- > 0;) {
+        const JsonNode &member_key = members[2 * i];
+        if (std::string_view(member_key.chars, member_key.length) == key)
+            return JsonView(&members[2 * i + 1]);
+    }
+    return JsonView();
+}
+
+std::string_view JsonView::key(size_t i) const {
+    if (!is_object() || i >= m_node->length)
+        return std::string_view();
+    const JsonNode &member_key = (m_node - m_node->children)[2 * i];
+    return std::string_view(member_key.chars, member_key.length);
+}
+
+JsonView JsonView::value(size_t i) const {
+    if (!is_object() || i >= m_node->length)
+        return JsonView();
+    return JsonView(m_node - m_node->children + 2 * i + 1);
+}
+
+Json JsonView::to_json() const {
+    switch (type()) {
+    case Json::NUMBER:
+        return number_value();
+    case Json::BOOL:
+        return bool_value();
+    case Json::STRING:
+        return string(string_value());
+    case Json::ARRAY: {
+        Json::array items;
+        items.reserve(size());
+        for (size_t i = 0; i < size(); i++)
+            items.push_back((*this)[i].to_json());
+        return items;
+    }
+    case Json::OBJECT: {
+        vector<Json::object::value_type> items;
+        items.reserve(size());
+        for (size_t i = 0; i < size(); i++)
+            items.emplace_back(string(key(i)), value(i).to_json());
+        return object_from_members(move(items));
+    }
+    default:
+        return Json();
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Events
+ */
+
+/* JsonEventParser::Reader
+ *
+ * Parses as much of one input (a chunk, or what was left of the last one followed by it) as
+ * it can, a token per step, with JsonParser's lexing. A token is only lexed once the whole of
+ * it is in the input, or there is no more input, so errors are the same as Json::parse's
+ * wherever the chunks were split.
+ */
+struct JsonEventParser::Reader final {
+
+    enum Step { STEPPED, WAITING, FAILED };
+
+    /* State
+     */
+    JsonEventParser &events;
+    JsonParser parser;
+    const bool final;
+
+    /* wait_at(pos)
+     *
+     * Stop, to resume from pos when there is more input.
+     */
+    Step wait_at(size_t pos) {
+        parser.i = pos;
+        return WAITING;
+    }
+
+    /* comment_ends(pos)
+     *
+     * Return whether the comment starting at pos ends in this input, or is malformed.
+     */
+    bool comment_ends(size_t pos) const {
+        const std::string_view &str = parser.str;
+        if (pos + 1 >= str.size())
+            return false;
+        if (str[pos + 1] == '/')
+            return str.find('\n', pos + 2) != std::string_view::npos;
+        if (str[pos + 1] == '*')
+            return str.find("*/", pos + 2) != std::string_view::npos;
+        return true;
+    }
+
+    /* string_ends(pos)
+     *
+     * Return whether the string whose contents start at pos ends in this input, or has an
+     * unescaped control character. A \u escape needs its four digits, even past the end of the
+     * string, since they are read together.
+     */
+    bool string_ends(size_t pos) const {
+        const std::string_view &str = parser.str;
+        while (true) {
+            pos = find_string_special(str, pos);
+            if (pos == str.size())
+                return false;
+            if (str[pos] != '\\')
+                return true;
+            size_t escape_length = (pos + 1 < str.size() && str[pos + 1] == 'u') ? 6 : 2;
+            if (pos + escape_length > str.size())
+                return false;
+            pos += 2;
+        }
+    }
+
+    /* number_ends(pos)
+     *
+     * Return whether the number starting at pos is followed by anything in this input.
+     */
+    bool number_ends(size_t pos) const {
+        const std::string_view &str = parser.str;
+        while (pos < str.size() && (in_range(str[pos], '0', '9') || str[pos] == '-'
+                || str[pos] == '+' || str[pos] == '.' || str[pos] == 'e' || str[pos] == 'E'))
+            pos++;
+        return pos < str.size();
+    }
+
+    /* skip_garbage()
+     *
+     * Like JsonParser::consume_garbage(), waiting for a comment to end instead of failing.
+     */
+    Step skip_garbage() {
+        while (true) {
+            parser.consume_whitespace();
+            if (parser.strategy != JsonParse::COMMENTS || parser.at(parser.i) != '/')
+                return STEPPED;
+            if (!final && !comment_ends(parser.i))
+                return WAITING;
+            parser.consume_comment();
+            if (parser.failed)
+                return FAILED;
+        }
+    }
+
+    /* next_token(ch)
+     *
+     * Like JsonParser::get_next_token(), waiting at the end of the input instead of failing.
+     */
+    Step next_token(char &ch) {
+        Step step = skip_garbage();
+        if (step != STEPPED)
+            return step;
+        if (!final && parser.i == parser.str.size())
+            return WAITING;
+        ch = parser.get_next_token();
+        return parser.failed ? FAILED : STEPPED;
+    }
+
+    /* read_string(out)
+     *
+     * Parse a string, starting after its opening quote, into out. It points into the input
+     * unless the string has escapes.
+     */
+    bool read_string(std::string_view &out) {
+        size_t end = find_string_special(parser.str, parser.i);
+        if (end < parser.str.size() && parser.str[end] == '"') {
+            out = parser.str.substr(parser.i, end - parser.i);
+            parser.i = end + 1;
+            return true;
+        }
+        events.m_decoded.clear();
+        if (!parser.parse_string_into(events.m_decoded))
+            return false;
+        out = events.m_decoded;
+        return true;
+    }
+
+    /* end_value()
+     *
+     * Expect what follows a value in whatever holds it.
+     */
+    Step end_value() {
+        if (events.m_containers.empty())
+            events.m_state = TRAILING;
+        else
+            events.m_state = events.m_containers.back() == '[' ? AFTER_ITEM : AFTER_MEMBER;
+        return STEPPED;
+    }
+
+    Step end_container() {
+        char container = events.m_containers.back();
+        events.m_containers.pop_back();
+        if (container == '[')
+            events.m_handler.end_array();
+        else
+            events.m_handler.end_object();
+        return end_value();
+    }
+
+    /* read_value(ch, start)
+     *
+     * Parse a value whose first character ch, at start, was just read.
+     */
+    Step read_value(char ch, size_t start) {
+        JsonHandler &handler = events.m_handler;
+
+        if (ch == '-' || (ch >= '0' && ch <= '9')) {
+            if (!final && !number_ends(start))
+                return wait_at(start);
+            parser.i = start;
+            double value;
+            bool is_int;
+            if (!parser.parse_number_into(value, is_int))
+                return FAILED;
+            handler.number_value(value);
+            return end_value();
+        }
+
+        if (ch == 't' || ch == 'f' || ch == 'n') {
+            string expected = ch == 't' ? "true" : ch == 'f' ? "false" : "null";
+            if (!final && parser.str.size() - start < expected.length())
+                return wait_at(start);
+            if (!parser.match(expected))
+                return FAILED;
+            if (ch == 'n')
+                handler.null_value();
+            else
+                handler.bool_value(ch == 't');
+            return end_value();
+        }
+
+        if (ch == '"') {
+            if (!final && !string_ends(parser.i))
+                return wait_at(start);
+            std::string_view value;
+            if (!read_string(value))
+                return FAILED;
+            handler.string_value(value);
+            return end_value();
+        }
+
+        if (ch == '[') {
+            events.m_containers.push_back(ch);
+            events.m_state = FIRST_ITEM;
+            handler.start_array();
+            return STEPPED;
+        }
+
+        if (ch == '{') {
+            events.m_containers.push_back(ch);
+            events.m_state = FIRST_KEY;
+            handler.start_object();
+            return STEPPED;
+        }
+
+        return parser.fail("expected value, got " + esc(ch), FAILED);
+    }
+
+    /* step()
+     *
+     * Parse the next token, following the same steps as JsonParser::parse_json().
+     */
+    Step step() {
+        State state = events.m_state;
+        // of the value to be read next, if any
+        size_t depth = events.m_containers.size();
+        char ch = 0;
+        Step step;
+
+        switch (state) {
+        case VALUE:
+            if (depth > static_cast<size_t>(max_depth))
+                return parser.fail("exceeded maximum nesting depth", FAILED);
+            if ((step = next_token(ch)) != STEPPED)
+                return step;
+            return read_value(ch, parser.i - 1);
+
+        case FIRST_ITEM:
+        case NEXT_ITEM:
+            if ((step = next_token(ch)) != STEPPED)
+                return step;
+            if (state == FIRST_ITEM && ch == ']')
+                return end_container();
+            if (depth > static_cast<size_t>(max_depth))
+                return parser.fail("exceeded maximum nesting depth", FAILED);
+            return read_value(ch, parser.i - 1);
+
+        case AFTER_ITEM:
+            if ((step = next_token(ch)) != STEPPED)
+                return step;
+            if (ch == ']')
+                return end_container();
+            if (ch != ',')
+                return parser.fail("expected ',' in list, got " + esc(ch), FAILED);
+            events.m_state = NEXT_ITEM;
+            return STEPPED;
+
+        case FIRST_KEY:
+        case NEXT_KEY: {
+            if ((step = next_token(ch)) != STEPPED)
+                return step;
+            if (state == FIRST_KEY && ch == '}')
+                return end_container();
+            if (ch != '"')
+                return parser.fail("expected '\"' in object, got " + esc(ch), FAILED);
+            if (!final && !string_ends(parser.i))
+                return wait_at(parser.i - 1);
+            std::string_view key;
+            if (!read_string(key))
+                return FAILED;
+            events.m_state = COLON;
+            events.m_handler.key(key);
+            return STEPPED;
+        }
+
+        case COLON:
+            if ((step = next_token(ch)) != STEPPED)
+                return step;
+            if (ch != ':')
+                return parser.fail("expected ':' in object, got " + esc(ch), FAILED);
+            events.m_state = VALUE;
+            return STEPPED;
+
+        case AFTER_MEMBER:
+            if ((step = next_token(ch)) != STEPPED)
+                return step;
+            if (ch == '}')
+                return end_container();
+            if (ch != ',')
+                return parser.fail("expected ',' in object, got " + esc(ch), FAILED);
+            events.m_state = NEXT_KEY;
+            return STEPPED;
+
+        case TRAILING:
+        default:
+            if ((step = skip_garbage()) != STEPPED)
+                return step;
+            if (parser.i == parser.str.size())
+                return WAITING;
+            return parser.fail("unexpected trailing " + esc(parser.str[parser.i]), FAILED);
+        }
+    }
+};
+
+JsonEventParser::JsonEventParser(JsonHandler &handler, string &err, JsonParse strategy)
+    : m_handler(handler), m_err(err), m_strategy(strategy), m_state(VALUE), m_failed(false) {}
+
+bool JsonEventParser::run(std::string_view input, bool final) {
+    Reader reader { *this, JsonParser { input, 0, m_err, false, m_strategy }, final };
+    Reader::Step step;
+    while ((step = reader.step()) == Reader::STEPPED) {}
+
+    if (step == Reader::FAILED) {
+        m_failed = true;
+        return false;
+    }
+    // only the end of the input can be waiting for more of it
+    m_pending.assign(input.substr(reader.parser.i));
+    return true;
+}
+
+bool JsonEventParser::feed(std::string_view chunk) {
+    if (m_failed)
+        return false;
+    if (m_pending.empty())
+        return run(chunk, false);
+    m_input.assign(m_pending);
+    m_input.append(chunk);
+    return run(m_input, false);
+}
+
+bool JsonEventParser::finish() {
+    if (m_failed)
+        return false;
+    m_input.swap(m_pending);
+    return run(m_input, true);
+}
+
+bool JsonEventParser::parse(std::string_view in, JsonHandler &handler, string &err,
+                            JsonParse strategy) {
+    JsonEventParser parser(handler, err, strategy);
+    return parser.feed(in) && parser.finish();
+}
+
 /* * * * * * * * * * * * * * * * * * * *
  * Shape-checking
  */
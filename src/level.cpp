@@ -0,0 +1,426 @@
+#include "level.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "json11.hpp"
+#include "bytebuffer.hpp"
+#include "hash.hpp"
+#include "mappedfile.hpp"
+
+constexpr char cookedMagic[4] = {'R', 'J', 'L', 'V'};
+constexpr uint16_t cookedVersion = 2;
+constexpr std::string_view cookedExtension = ".cooked";
+constexpr size_t cookedHeaderSize = 40;
+// big enough that a player only ever needs a few, small enough that
+// those few don't hold much more than what's around them
+constexpr float cookedChunkSize = 32.0f;
+
+// walls and chunks are copied to and from cooked files as they are
+static_assert(sizeof(WallDefinition) == 4 * sizeof(float));
+static_assert(sizeof(LevelChunk) == 8 * sizeof(uint32_t));
+
+struct CookedHeader {
+    std::array<char, 4> magic;
+    uint16_t version;
+    uint32_t wallCount;
+    uint32_t chunkCount;
+    uint64_t sourceHash;
+    uint64_t contentHash;
+    float chunkSize;
+};
+
+CookedHeader readCookedHeader(const uint8_t *data) {
+    ByteReader reader(data, cookedHeaderSize);
+    CookedHeader header;
+    header.magic = reader.get<std::array<char, 4>>();
+    header.version = reader.get<uint16_t>();
+    reader.get<uint16_t>();
+    header.wallCount = reader.get<uint32_t>();
+    header.chunkCount = reader.get<uint32_t>();
+    header.sourceHash = reader.get<uint64_t>();
+    header.contentHash = reader.get<uint64_t>();
+    header.chunkSize = reader.get<float>();
+    return header;
+}
+
+const Level& Level::builtin() {
+    static const Level level = {
+        .walls = {{b2Vec2{-10, 10}, b2Vec2{20, 5}}},
+    };
+    return level;
+}
+
+uint64_t Level::hash() const {
+    return fnv1a(walls.data(), walls.size() * sizeof(WallDefinition));
+}
+
+std::string_view asText(const MappedFile& file) {
+    return {reinterpret_cast<const char *>(file.data()), file.size()};
+}
+
+std::string pairError(size_t wallIndex, const char *key) {
+    return "level: wall " + std::to_string(wallIndex) + " needs a \"" + key + "\" of two numbers";
+}
+
+/**
+ * @brief Fills a level from the events of its JSON source, as they are parsed,
+ * so nothing but the walls is ever held.
+ *
+ * Anything besides walls is skipped, and like a lookup in a parsed tree, the
+ * last of repeated keys wins. The first wall that isn't valid is only reported
+ * by check(), once the whole source has parsed, so syntax errors come first.
+ */
+class LevelReader: public json11::JsonHandler {
+    enum class Pair {NONE, POSITION, SIZE};
+
+    Level& level;
+    // containers open around the next event, the root object being the first
+    size_t depth = 0;
+    bool atWallsKey = false;
+    bool hasWalls = false;
+    bool inWalls = false;
+    bool inWall = false;
+    std::string wallError;
+
+    // the wall being read, and which of its pairs were two numbers
+    WallDefinition wall = {};
+    Pair pairKey = Pair::NONE;
+    bool hasPosition = false;
+    bool hasSize = false;
+
+    // the pair being read
+    bool inPair = false;
+    bool pairValid = false;
+    size_t pairLength = 0;
+    float pairValues[2] = {};
+
+    void setWalls(bool isArray) {
+        level.walls.clear();
+        wallError.clear();
+        hasWalls = isArray;
+        inWalls = isArray;
+    }
+
+    void startWall() {
+        wall = {};
+        pairKey = Pair::NONE;
+        hasPosition = false;
+        hasSize = false;
+        inWall = true;
+    }
+
+    void endWall() {
+        size_t index = level.walls.size();
+        if (wallError.empty() && !hasPosition)
+            wallError = pairError(index, "position");
+        else if (wallError.empty() && !hasSize)
+            wallError = pairError(index, "size");
+        level.walls.push_back(wall);
+        inWall = false;
+    }
+
+    void endPair() {
+        inPair = false;
+        if (!pairValid || pairLength != 2)
+            return;
+        b2Vec2 pair = {pairValues[0], pairValues[1]};
+        if (pairKey == Pair::POSITION) {
+            wall.position = pair;
+            hasPosition = true;
+        } else {
+            wall.dimensions = pair;
+            hasSize = true;
+        }
+    }
+
+    // anything but an array or an object, number being nullptr if it isn't one either
+    void scalar(const double *number) {
+        if (depth == 1 && atWallsKey) {
+            setWalls(false);
+        } else if (depth == 2 && inWalls) {
+            // not an object, so without a position
+            startWall();
+            endWall();
+        } else if (depth == 4 && inPair) {
+            if (number == nullptr)
+                pairValid = false;
+            else if (pairLength < 2)
+                pairValues[pairLength] = static_cast<float>(*number);
+            pairLength++;
+        }
+    }
+
+    void startContainer(bool isObject) {
+        if (depth == 1 && atWallsKey) {
+            setWalls(!isObject);
+        } else if (depth == 2 && inWalls) {
+            startWall();
+            if (!isObject)
+                endWall();
+        } else if (depth == 3 && inWall && pairKey != Pair::NONE && !isObject) {
+            inPair = true;
+            pairValid = true;
+            pairLength = 0;
+        } else if (depth == 4 && inPair) {
+            pairValid = false;
+        }
+        depth++;
+    }
+
+    void endContainer() {
+        depth--;
+        if (depth == 1 && inWalls)
+            inWalls = false;
+        else if (depth == 2 && inWall)
+            endWall();
+        else if (depth == 3 && inPair)
+            endPair();
+    }
+public:
+    explicit LevelReader(Level& level): level(level) {}
+
+    void null_value() override { scalar(nullptr); }
+    void bool_value(bool) override { scalar(nullptr); }
+    void number_value(double value) override { scalar(&value); }
+    void string_value(std::string_view) override { scalar(nullptr); }
+    void start_array() override { startContainer(false); }
+    void end_array() override { endContainer(); }
+    void start_object() override { startContainer(true); }
+    void end_object() override { endContainer(); }
+
+    void key(std::string_view key) override {
+        if (depth == 1) {
+            atWallsKey = key == "walls";
+        } else if (depth == 3 && inWall) {
+            pairKey = key == "position" ? Pair::POSITION : key == "size" ? Pair::SIZE : Pair::NONE;
+            // the last one wins, even if it isn't valid
+            if (pairKey == Pair::POSITION)
+                hasPosition = false;
+            else if (pairKey == Pair::SIZE)
+                hasSize = false;
+        }
+    }
+
+    /**
+     * @throws std::runtime_error If the source had no walls or an invalid wall.
+     */
+    void check() const {
+        if (!hasWalls)
+            throw std::runtime_error("level: missing the \"walls\" array");
+        if (!wallError.empty())
+            throw std::runtime_error(wallError);
+    }
+};
+
+Level parseLevel(std::string_view json) {
+    // read as it's parsed, without building a tree as big as the level first
+    Level level;
+    LevelReader reader(level);
+    std::string error;
+    if (!json11::JsonEventParser::parse(json, reader, error))
+        throw std::runtime_error("level: " + error);
+    reader.check();
+    return level;
+}
+
+// the header, if data holds a whole cooked level cooked from a source with this hash
+std::optional<CookedHeader> validateCooked(const uint8_t *data, size_t size, uint64_t sourceHash) {
+    if (size < cookedHeaderSize)
+        return std::nullopt;
+    CookedHeader header = readCookedHeader(data);
+    uint64_t contentSize = static_cast<uint64_t>(header.chunkCount) * sizeof(LevelChunk)
+        + static_cast<uint64_t>(header.wallCount) * sizeof(WallDefinition);
+    bool valid = std::equal(header.magic.begin(), header.magic.end(), cookedMagic)
+        && header.version == cookedVersion
+        && header.sourceHash == sourceHash
+        && size - cookedHeaderSize == contentSize
+        && fnv1a(data + cookedHeaderSize, contentSize) == header.contentHash;
+    if (!valid)
+        return std::nullopt;
+    return header;
+}
+
+int32_t chunkCoordinate(float meters, float chunkSize) {
+    return static_cast<int32_t>(std::floor(meters / chunkSize));
+}
+
+std::vector<uint8_t> cookLevel(const Level& level, uint64_t sourceHash) {
+    struct ChunkedWall {
+        int32_t x;
+        int32_t y;
+        const WallDefinition *wall;
+    };
+    std::vector<ChunkedWall> sorted;
+    sorted.reserve(level.walls.size());
+    for (const WallDefinition& wall: level.walls) {
+        b2Vec2 center = wall.position + 0.5f * wall.dimensions;
+        sorted.push_back({
+            chunkCoordinate(center.x, cookedChunkSize),
+            chunkCoordinate(center.y, cookedChunkSize),
+            &wall
+        });
+    }
+    // stable, so walls keep their authored order within a chunk
+    std::stable_sort(sorted.begin(), sorted.end(), [](const ChunkedWall& a, const ChunkedWall& b) {
+        return std::pair(a.x, a.y) < std::pair(b.x, b.y);
+    });
+
+    std::vector<LevelChunk> chunks;
+    std::vector<WallDefinition> walls;
+    walls.reserve(sorted.size());
+    for (const ChunkedWall& entry: sorted) {
+        const WallDefinition& wall = *entry.wall;
+        b2Vec2 farCorner = wall.position + wall.dimensions;
+        if (chunks.empty() || chunks.back().x != entry.x || chunks.back().y != entry.y) {
+            chunks.push_back({
+                .x = entry.x,
+                .y = entry.y,
+                .firstWall = static_cast<uint32_t>(walls.size()),
+                .wallCount = 0,
+                .lowerBound = wall.position,
+                .upperBound = farCorner,
+            });
+        }
+        LevelChunk& chunk = chunks.back();
+        chunk.wallCount++;
+        chunk.lowerBound = b2Min(chunk.lowerBound, wall.position);
+        chunk.upperBound = b2Max(chunk.upperBound, farCorner);
+        walls.push_back(wall);
+    }
+
+    size_t chunksSize = chunks.size() * sizeof(LevelChunk);
+    size_t wallsSize = walls.size() * sizeof(WallDefinition);
+    std::vector<uint8_t> content(chunksSize + wallsSize);
+    std::memcpy(content.data(), chunks.data(), chunksSize);
+    std::memcpy(content.data() + chunksSize, walls.data(), wallsSize);
+
+    std::vector<uint8_t> cooked;
+    cooked.reserve(cookedHeaderSize + content.size());
+    ByteWriter writer(cooked);
+    for (char c: cookedMagic)
+        writer.put(c);
+    writer.put(cookedVersion);
+    writer.put<uint16_t>(0);
+    writer.put(static_cast<uint32_t>(walls.size()));
+    writer.put(static_cast<uint32_t>(chunks.size()));
+    writer.put(sourceHash);
+    writer.put(fnv1a(content.data(), content.size()));
+    writer.put(cookedChunkSize);
+    writer.put<uint32_t>(0);
+    cooked.insert(cooked.end(), content.begin(), content.end());
+    return cooked;
+}
+
+bool writeFileAtomically(std::string_view path, const std::vector<uint8_t>& bytes) {
+    // written aside and renamed over, so a crash never leaves half a file
+    // that a later load would have to detect
+    std::string temporaryPath = std::string(path) + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        if (!file) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, std::string(path), error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+std::optional<MappedFile> mapIfExists(std::string_view path) {
+    try {
+        return MappedFile(path);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+}
+
+// every wall of a validated cooked level
+Level levelFromCooked(const uint8_t *data) {
+    CookedHeader header = readCookedHeader(data);
+    Level level;
+    level.walls.resize(header.wallCount);
+    const uint8_t *walls = data + cookedHeaderSize + header.chunkCount * sizeof(LevelChunk);
+    std::memcpy(level.walls.data(), walls, header.wallCount * sizeof(WallDefinition));
+    return level;
+}
+
+Level loadLevel(std::string_view path) {
+    // mapped, so hashing and parsing read it in place instead of copies of it
+    MappedFile source(path);
+    std::string_view json = asText(source);
+    // hashing the source is much cheaper than parsing it, and catches any edit
+    uint64_t sourceHash = fnv1a(json.data(), json.size());
+    std::string cookedPath = std::string(path) + std::string(cookedExtension);
+
+    if (std::optional<Level> cooked = readCookedLevel(cookedPath, sourceHash))
+        return std::move(*cooked);
+
+    // returned as cooked, so walls come in the same order with or without the cache
+    std::vector<uint8_t> cooked = cookLevel(parseLevel(json), sourceHash);
+    writeFileAtomically(cookedPath, cooked);
+    return levelFromCooked(cooked.data());
+}
+
+std::optional<Level> readCookedLevel(std::string_view cookedPath, uint64_t sourceHash) {
+    std::optional<MappedFile> file = mapIfExists(cookedPath);
+    if (!file)
+        return std::nullopt;
+    if (!validateCooked(file->data(), file->size(), sourceHash))
+        return std::nullopt;
+    return levelFromCooked(file->data());
+}
+
+bool writeCookedLevel(std::string_view cookedPath, const Level& level, uint64_t sourceHash) {
+    return writeFileAtomically(cookedPath, cookLevel(level, sourceHash));
+}
+
+ChunkedLevel::ChunkedLevel(std::string_view path) {
+    MappedFile source(path);
+    std::string_view json = asText(source);
+    uint64_t sourceHash = fnv1a(json.data(), json.size());
+    std::string cookedPath = std::string(path) + std::string(cookedExtension);
+
+    file = mapIfExists(cookedPath);
+    if (file && validateCooked(file->data(), file->size(), sourceHash)) {
+        useCooked(file->data());
+        return;
+    }
+    file.reset();
+
+    // a cache that can't be written is still worth using for this run
+    cookedInMemory = cookLevel(parseLevel(json), sourceHash);
+    writeFileAtomically(cookedPath, cookedInMemory);
+    useCooked(cookedInMemory.data());
+}
+
+void ChunkedLevel::useCooked(const uint8_t *data) {
+    // already validated
+    CookedHeader header = readCookedHeader(data);
+
+    chunkSize = header.chunkSize;
+    chunks.resize(header.chunkCount);
+    std::memcpy(chunks.data(), data + cookedHeaderSize, header.chunkCount * sizeof(LevelChunk));
+    walls = data + cookedHeaderSize + header.chunkCount * sizeof(LevelChunk);
+}
+
+float ChunkedLevel::getChunkSize() const {
+    return chunkSize;
+}
+
+std::span<const LevelChunk> ChunkedLevel::getChunks() const {
+    return chunks;
+}
+
+void ChunkedLevel::readWalls(const LevelChunk& chunk, std::vector<WallDefinition>& out) const {
+    out.resize(chunk.wallCount);
+    std::memcpy(out.data(), walls + chunk.firstWall * sizeof(WallDefinition), chunk.wallCount * sizeof(WallDefinition));
+}
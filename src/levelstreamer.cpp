@@ -0,0 +1,179 @@
+#include "levelstreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+LevelStreamer::LevelStreamer(b2World& world, ChunkedLevel level, LevelStreamingOptions options):
+    world(world),
+    level(std::move(level)),
+    options(options),
+    loader(&LevelStreamer::loaderLoop, this) {}
+
+LevelStreamer::~LevelStreamer() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    loader.join();
+}
+
+void LevelStreamer::loaderLoop() {
+    while (true) {
+        uint32_t chunkIndex;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this](){ return stopping || !requests.empty(); });
+            if (stopping) return;
+            chunkIndex = requests.front();
+            requests.pop_front();
+        }
+        // page faults on the mapped level happen here, not on the stepping thread
+        ReadChunk read = {chunkIndex, {}};
+        level.readWalls(level.getChunks()[chunkIndex], read.definitions);
+        {
+            std::lock_guard lock(mutex);
+            ready.push_back(std::move(read));
+            pendingReads--;
+        }
+        readDone.notify_all();
+    }
+}
+
+void LevelStreamer::update(std::span<const b2Vec2> focus) {
+    // ranges are measured from whole chunks, so only moving to another
+    // one can change which chunks are in range
+    float chunkSize = level.getChunkSize();
+    std::vector<std::pair<int32_t, int32_t>>& cells = scratchCells;
+    cells.clear();
+    for (b2Vec2 point: focus) {
+        cells.emplace_back(
+            static_cast<int32_t>(std::floor(point.x / chunkSize)),
+            static_cast<int32_t>(std::floor(point.y / chunkSize))
+        );
+    }
+    if (cells != focusCells) {
+        focusCells.swap(cells);
+        refreshChunksInRange();
+    }
+
+    takeReadChunks();
+    createWalls(options.wallsPerUpdate);
+}
+
+void LevelStreamer::finishLoading() {
+    {
+        std::unique_lock lock(mutex);
+        readDone.wait(lock, [this](){ return pendingReads == 0; });
+    }
+    takeReadChunks();
+    createWalls(SIZE_MAX);
+}
+
+// how far apart a chunk's walls are from a focus cell, 0 if they overlap
+float distanceToCell(const LevelChunk& chunk, std::pair<int32_t, int32_t> cell, float chunkSize) {
+    b2Vec2 cellLower = {cell.first * chunkSize, cell.second * chunkSize};
+    b2Vec2 cellUpper = cellLower + b2Vec2{chunkSize, chunkSize};
+    float dx = std::max({0.0f, cellLower.x - chunk.upperBound.x, chunk.lowerBound.x - cellUpper.x});
+    float dy = std::max({0.0f, cellLower.y - chunk.upperBound.y, chunk.lowerBound.y - cellUpper.y});
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+void LevelStreamer::refreshChunksInRange() {
+    std::span<const LevelChunk> levelChunks = level.getChunks();
+    float chunkSize = level.getChunkSize();
+    std::vector<uint32_t> newRequests;
+    for (uint32_t i = 0; i < levelChunks.size(); i++) {
+        float distance = INFINITY;
+        for (std::pair<int32_t, int32_t> cell: focusCells)
+            distance = std::min(distance, distanceToCell(levelChunks[i], cell, chunkSize));
+
+        bool streamed = chunks.contains(i);
+        if (!streamed && distance <= options.loadDistance) {
+            chunks.try_emplace(i);
+            newRequests.push_back(i);
+        } else if (streamed && distance > options.unloadDistance) {
+            unload(i);
+        }
+    }
+    if (newRequests.empty()) return;
+
+    {
+        std::lock_guard lock(mutex);
+        requests.insert(requests.end(), newRequests.begin(), newRequests.end());
+        pendingReads += newRequests.size();
+    }
+    wake.notify_one();
+}
+
+void LevelStreamer::unload(uint32_t chunkIndex) {
+    StreamedChunk& chunk = chunks.at(chunkIndex);
+    bodyCount -= chunk.walls.size();
+    if (!chunk.read) {
+        // still queued, or being read, in which case the result is dropped on arrival
+        std::lock_guard lock(mutex);
+        auto queued = std::find(requests.begin(), requests.end(), chunkIndex);
+        if (queued != requests.end()) {
+            requests.erase(queued);
+            pendingReads--;
+        }
+    }
+    if (chunk.read && chunk.created < chunk.definitions.size())
+        std::erase(creating, chunkIndex);
+    // destroys the bodies, fine since this never runs during a step
+    chunks.erase(chunkIndex);
+}
+
+void LevelStreamer::takeReadChunks() {
+    {
+        std::lock_guard lock(mutex);
+        received.swap(ready);
+    }
+    for (ReadChunk& read: received) {
+        auto streamed = chunks.find(read.chunkIndex);
+        // unloaded while it was being read, or read twice after being
+        // unloaded and requested again
+        if (streamed == chunks.end() || streamed->second.read) continue;
+        StreamedChunk& chunk = streamed->second;
+        chunk.definitions = std::move(read.definitions);
+        chunk.read = true;
+        creating.push_back(read.chunkIndex);
+    }
+    received.clear();
+}
+
+void LevelStreamer::createWalls(size_t budget) {
+    while (budget > 0 && !creating.empty()) {
+        StreamedChunk& chunk = chunks.at(creating.front());
+        size_t count = std::min(budget, chunk.definitions.size() - chunk.created);
+        for (size_t i = 0; i < count; i++) {
+            const WallDefinition& wall = chunk.definitions[chunk.created + i];
+            chunk.walls.emplace_back(world, wall.position, wall.dimensions);
+        }
+        chunk.created += count;
+        chunk.layer.invalidate();
+        bodyCount += count;
+        budget -= count;
+        if (chunk.created == chunk.definitions.size()) {
+            // only needed until the bodies exist
+            std::vector<WallDefinition>().swap(chunk.definitions);
+            chunk.created = 0;
+            creating.pop_front();
+        }
+    }
+}
+
+void LevelStreamer::render(RenderCommandBuffer& commands, const Rectangle *view) const {
+    for (const auto& [index, chunk]: chunks) {
+        chunk.layer.render(commands, chunk.walls, view);
+    }
+}
+
+size_t LevelStreamer::loadedChunkCount() const {
+    return chunks.size();
+}
+
+size_t LevelStreamer::wallCount() const {
+    return bodyCount;
+}
@@ -1,29 +1,23 @@
 #include <raylib.h>
 #include <box2d/box2d.h>
-#include <array>
+#include <chrono>
 #include <sstream>
 #include <iomanip>
-#include <deque>
 #include <optional>
-#include <set>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
-#include "player.hpp"
-#include "wall.hpp"
-#include "rocket.hpp"
 #include "world.hpp"
-#include "explosion.hpp"
-#include "recoilwave.hpp"
-#include "json11.hpp"
-
-void explode(b2World& world, std::deque<Explosion *>& explosions, b2Vec2 position) {
-    // if it explodes in the air, spawn explosion at its center
-    auto explosion = new Explosion(world, position);
-    explosions.push_back(explosion);
-    // DO NOT DELETE ROCKET
-    // this is done in the cleanup stage of spawning explosions
-}
+#include "simulation.hpp"
+#include "headless.hpp"
+#include "replay.hpp"
+#include "profiler.hpp"
+#include "level.hpp"
+#include "rendercommands.hpp"
+#include "raylibbackend.hpp"
+#include "simulationthread.hpp"
 
 b2Vec2 getMousePositionInWorld(Camera2D& camera) {
     Vector2 mousePositionScreen = GetMousePosition();
@@ -31,101 +25,6 @@ b2Vec2 getMousePositionInWorld(Camera2D& camera) {
     return raylibToBox2d(mousePositionCamera);
 }
 
-class ContactListener: public b2ContactListener {
-    b2World& world;
-    std::deque<Explosion *>& explosions;
-    std::set<uintptr_t>& explosionsWithinRangeOfPlayer;
-    Rocket *explodingRocket = nullptr;
-    bool shouldCreateExplosion = false;
-    b2Vec2 explosionLocation;
-public:
-    ContactListener(
-        b2World& world,
-        std::deque<Explosion *>& explosions,
-        std::set<uintptr_t>& explosionsWithinRangeOfPlayer
-    ):
-        world(world),
-        explosions(explosions),
-        explosionsWithinRangeOfPlayer(explosionsWithinRangeOfPlayer),
-        shouldCreateExplosion(false) {}
-
-    void BeginContact(b2Contact *contact) {
-        using Type = Entity::EntityType;
-        Entity *a = Entity::fromFixture(contact->GetFixtureA());
-        Entity *b = Entity::fromFixture(contact->GetFixtureB());
-
-        if (b->type == Type::ROCKET) {
-            std::swap(a, b);
-        }
-
-        if (a->type == Type::ROCKET && b->type == Type::TERRAIN) {
-            // set variables to create explosion later in the frame
-
-            b2WorldManifold manifold;
-            contact->GetWorldManifold(&manifold);
-
-            // always spawns explosions in the first contact point
-            // maybe fix this later, but it probably doesn't matter
-            setupForExplosion(dynamic_cast<Rocket *>(a), manifold.points[0]);
-            return;
-        }
-
-        if (b->type == Type::EXPLOSION) {
-            std::swap(a, b);
-        }
-
-        if (a->type == Type::EXPLOSION) {
-            Rocket *r;
-            switch (b->type) {
-            case Type::PLAYER:
-                explosionsWithinRangeOfPlayer.insert(a->toUserDataPointer());
-                break;
-            case Type::ROCKET:
-                r = dynamic_cast<Rocket *>(b);
-                setupForExplosion(r, r->box2dPosition());
-                break;
-            case Type::EXPLOSION:
-                break;
-            case Type::TERRAIN:
-                // TODO destructible terrain, maybe on separate entity type
-                break;
-            case Type::RECOIL_WAVE:
-                break;
-            }
-            return;
-        }
-    }
-
-    void EndContact(b2Contact *contact) {
-        using Type = Entity::EntityType;
-        Entity *a = Entity::fromFixture(contact->GetFixtureA());
-        Entity *b = Entity::fromFixture(contact->GetFixtureB());
-
-        if (b->type == Type::PLAYER) {
-            std::swap(a, b);
-        }
-
-        if (a->type == Type::PLAYER && b->type == Type::EXPLOSION) {
-            explosionsWithinRangeOfPlayer.erase(b->toUserDataPointer());
-        }
-    }
-
-    void setupForExplosion(Rocket *rocket, b2Vec2 position) {
-        if (rocket->hasExploded()) return;
-        rocket->collide();
-        shouldCreateExplosion = true;
-        explodingRocket = rocket;
-        explosionLocation = position;
-    }
-
-    void processQueuedExplosionIfAny() {
-        if (shouldCreateExplosion) {
-            explode(world, explosions, explosionLocation);
-            shouldCreateExplosion = false;
-        }
-    }
-};
-
 template<typename T>
 void write(const T& what, int x, int y, float fontSize, Color color) {
     std::stringstream buf;
@@ -133,173 +32,189 @@ void write(const T& what, int x, int y, float fontSize, Color color) {
     DrawText(buf.str().c_str(), x, y, fontSize, color);
 }
 
-// Obtained from stack overflow
-// https://stackoverflow.com/a/116220
-auto readFile(std::string_view path) -> std::string {
-    constexpr auto read_size = std::size_t(4096);
-    auto stream = std::ifstream(path.data());
-    stream.exceptions(std::ios_base::badbit);
-
-    if (not stream) {
-        throw std::ios_base::failure("file does not exist");
-    }
-
-    auto out = std::string();
-    auto buf = std::string(read_size, '\0');
-    while (stream.read(& buf[0], read_size)) {
-        out.append(buf, 0, stream.gcount());
-    }
-    out.append(buf, 0, stream.gcount());
-    return out;
+constexpr int screenWidth = 1600;
+constexpr int screenHeight = 900;
+
+constexpr uint64_t defaultHeadlessTicks = 100000;
+constexpr int defaultRenderStatsFrames = 300;
+constexpr std::string_view defaultTracePath = "trace.json";
+constexpr std::string_view traceOption = "--trace=";
+constexpr std::string_view levelOption = "--level=";
+constexpr std::string_view streamLevelOption = "--stream-level=";
+
+// takes the simulation options out of the arguments, leaving the positional ones
+SimulationOptions parseSimulationOptions(std::vector<std::string_view>& args) {
+    SimulationOptions options;
+    std::erase_if(args, [&options](std::string_view arg) {
+        if (arg == "--explosion-queries") {
+            options.explosionDetection = ExplosionDetection::QUERIES;
+        } else if (arg == "--timer-wheel") {
+            options.timerWheel = true;
+        } else {
+            return false;
+        }
+        return true;
+    });
+    return options;
 }
 
-std::optional<json11::Json> parseJson(const std::string_view& filename) {
-    std::string dump = readFile(filename);
-    std::string err;
-    json11::Json obj = json11::Json::parse(dump, err);
-    if (obj.is_null()) {
-        std::cerr << err << std::endl;
-        return std::nullopt;
-    } else {
-        return obj;
-    }
+// takes --option=<value> out of the arguments, returns the value or an empty string
+std::string takeOptionValue(std::vector<std::string_view>& args, std::string_view option) {
+    std::string value;
+    std::erase_if(args, [&](std::string_view arg) {
+        if (!arg.starts_with(option)) return false;
+        value = arg.substr(option.size());
+        return true;
+    });
+    return value;
 }
 
-int main(int argc, char *argv[]) {
-    const int screenWidth = 1600;
-    const int screenHeight = 900;
-
-    // {
-    //     std::optional<json11::Json> jv = parseJson(".vscode/c_cpp_properties.json");
-    //     std::string jsonObjDump;
-    //     jv.value_or(json11::Json::NUL).dump(jsonObjDump);
-    //     std::cout << jsonObjDump << std::endl;
-    //     return 0;
-    // }
-
-    // TODO reset button
-    InitWindow(screenWidth, screenHeight, "Rocket Jump!");
-    SetTargetFPS(60);
-
-    float timeSlice = 0;
-
-    b2World world({0.0f, 20.0f});
-
-    auto player = Player(world, b2Vec2{0, 0});
-    auto wall = Wall(world, b2Vec2{-10, 10}, b2Vec2{20, 5});
-    std::array<Rocket *, Player::maxRockets> rockets;
-    int rocketIndex = 0;
-    std::deque<Explosion *> explosions;
-    std::set<uintptr_t> explosionsWithinRangeOfPlayer;
-    RecoilWave recoilWave(world);
-
-    ContactListener cl(world, explosions, explosionsWithinRangeOfPlayer);
-    world.SetContactListener(&cl);
+void saveTrace(std::string_view path) {
+    if (!PROFILER_ENABLED)
+        std::cerr << "profiler was not compiled in, build with PROFILE=1" << std::endl;
+    std::ofstream file(std::string(path), std::ios::binary);
+    writeChromeTrace(file);
+    std::cout << "trace written to " << path << std::endl;
+}
 
-    Camera2D camera;
+Camera2D gameCamera() {
+    Camera2D camera = {};
     camera.zoom = 2.0f;
     camera.offset = { screenWidth/2, screenHeight/2 };
+    return camera;
+}
 
-    auto updateExplosions = [&]() {
-        for (Explosion *explosion: explosions)
-            explosion->update(SIMULATION_STEP_INTERVAL);
-        while (explosions.size() > 0 && explosions.front()->isOver()) {
-            auto endedExplosion = explosions.front();
-            explosions.pop_front();
-            delete endedExplosion;
-        }
-    };
-
-    auto updatePlayer = [&]() {
-        for (uintptr_t explosionUserData: explosionsWithinRangeOfPlayer) {
-            auto explosion = reinterpret_cast<Explosion *>(explosionUserData);
-            player.feelExplosion(*explosion);
-        }
-        player.update(SIMULATION_STEP_INTERVAL);
-    };
-
-    auto updateRockets = [&]() {
-        for (Rocket *rocket: rockets) {
-            if (rocket != nullptr) {
-                rocket->update(SIMULATION_STEP_INTERVAL);
-                if (rocket->shouldExplodeByAge())
-                    explode(world, explosions, rocket->box2dPosition());
-            }
-        }
-        cl.processQueuedExplosionIfAny();
-        for (Rocket *&rocketRef: rockets) {
-            if (rocketRef != nullptr && rocketRef->hasExploded()) {
-                delete rocketRef;
-                rocketRef = nullptr;
-            }
-        }
-    };
+// draws the simulation and feeds it input until the window is closed,
+// while it steps on its own thread
+void runWindowed(Simulation& simulation, ReplayWriter *recorder, std::string_view tracePath) {
+    Camera2D camera = gameCamera();
+    RenderCommandBuffer commands;
+    RaylibBackend backend;
+    SimulationThread simulationThread(simulation, recorder);
+    simulationThread.setView(cameraView(camera, {screenWidth, screenHeight}));
 
     auto handleInputs = [&]() {
-        std::optional<b2Vec2> mousePosInWorld = std::nullopt;
-        if (IsMouseButtonPressed(MouseButton::MOUSE_BUTTON_LEFT)) {
-            mousePosInWorld = getMousePositionInWorld(camera);
-            Rocket *newRocket = player.shootRocketTowards(mousePosInWorld.value());
-            if (newRocket != nullptr) {
-                rockets.at(rocketIndex) = newRocket;
-                rocketIndex = (rocketIndex + 1) % 3;
-            }
-        }
-
-        if (IsMouseButtonPressed(MouseButton::MOUSE_BUTTON_RIGHT)) {
-            player.startChargingRecoil();
-        }
-
-        if (IsMouseButtonReleased(MouseButton::MOUSE_BUTTON_RIGHT)) {
-            // use cached value if available
-            if (!mousePosInWorld)
-                mousePosInWorld = getMousePositionInWorld(camera);
-            player.recoilFrom(mousePosInWorld.value(), recoilWave);
-        }
+        TickInput input;
+        input.leftPressed = IsMouseButtonPressed(MouseButton::MOUSE_BUTTON_LEFT);
+        input.leftReleased = IsMouseButtonReleased(MouseButton::MOUSE_BUTTON_LEFT);
+        input.rightPressed = IsMouseButtonPressed(MouseButton::MOUSE_BUTTON_RIGHT);
+        input.rightReleased = IsMouseButtonReleased(MouseButton::MOUSE_BUTTON_RIGHT);
+        input.target = getMousePositionInWorld(camera);
+        simulationThread.queueInput(input);
     };
 
     while (!WindowShouldClose()) {
-        timeSlice += GetFrameTime();
-        if (timeSlice >= SIMULATION_STEP_INTERVAL) {
-            world.Step(SIMULATION_STEP_INTERVAL, SIMULATION_VELOCITY_ITER, SIMULATION_POSITION_ITER);
-            // process explosions first to allow frame-1-explosion interactions to happen
-            updateExplosions();
-            updatePlayer();
-            updateRockets();
-            recoilWave.update(SIMULATION_STEP_INTERVAL);
-
-            timeSlice -= SIMULATION_STEP_INTERVAL;
-        }
-
         // TODO more refined camera movement
         // camera.target = player.raylibPosition();
 
         handleInputs();
-
+        if (IsKeyPressed(KEY_F9))
+            saveTrace(tracePath.empty() ? defaultTracePath : tracePath);
+        if (IsKeyPressed(KEY_F8))
+            WallLayer::setCachingEnabled(!WallLayer::isCachingEnabled());
+
+        RJ_PROFILE_SCOPE("render");
+        const RenderFrame& frame = simulationThread.latestFrame();
+        commands.interpolate(frame.previous, frame.current, frame.alphaAt(std::chrono::steady_clock::now()));
         BeginDrawing();
             ClearBackground(BLACK);
             BeginMode2D(camera);
-                for (const Explosion *explosion: explosions) {
-                    explosion->render();
-                }
-                for (const Rocket *rocket: rockets) {
-                    if (rocket != nullptr)
-                        rocket->render();
-                }
-                // render recoil wave before player so it hides it spawning in
-                recoilWave.render();
-                player.render();
-                wall.render();
+                backend.draw(commands);
             EndMode2D();
 
 #ifdef DEBUG
-            write(player.getRocketAmmo(), 0, 0, 32, WHITE);
-            write(player.getRocketReload(), 0, 32, 32, WHITE);
-            write(player.getRecoilReload(), 0, 64, 32, WHITE);
+            write(frame.rocketAmmo, 0, 0, 32, WHITE);
+            write(frame.rocketReload, 0, 32, 32, WHITE);
+            write(frame.recoilReload, 0, 64, 32, WHITE);
+            write(commands.size(), 0, 96, 32, WHITE);
 #endif
         EndDrawing();
     }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string_view> args(argv, argv + argc);
+    SimulationOptions options = parseSimulationOptions(args);
+    std::string tracePath = takeOptionValue(args, traceOption);
+    std::string levelPath = takeOptionValue(args, levelOption);
+    std::string streamLevelPath = takeOptionValue(args, streamLevelOption);
+
+    std::string_view mode = args.size() > 1 ? args[1] : "";
+    if (mode == "--headless") {
+        uint64_t ticks = args.size() > 2 ? std::stoull(std::string(args[2])) : defaultHeadlessTicks;
+        std::string_view recordPath = args.size() > 3 ? args[3] : "";
+        int exitCode = runHeadless(ticks, recordPath, options);
+        if (!tracePath.empty()) saveTrace(tracePath);
+        return exitCode;
+    }
+    if (mode == "--batch") {
+        if (args.size() < 3) {
+            std::cerr << "usage: " << argv[0] << " --batch <worlds> [ticks]" << std::endl;
+            return 1;
+        }
+        size_t worldCount = std::stoull(std::string(args[2]));
+        uint64_t ticks = args.size() > 3 ? std::stoull(std::string(args[3])) : defaultHeadlessTicks;
+        int exitCode = runBatch(worldCount, ticks, options);
+        if (!tracePath.empty()) saveTrace(tracePath);
+        return exitCode;
+    }
+    if (mode == "--rollback") {
+        uint64_t ticks = args.size() > 2 ? std::stoull(std::string(args[2])) : defaultHeadlessTicks;
+        LoopbackOptions network;
+        if (args.size() > 3) network.latency = std::stof(std::string(args[3])) / 1000.0f;
+        if (args.size() > 4) network.jitter = std::stof(std::string(args[4])) / 1000.0f;
+        int exitCode = runRollback(ticks, network, options);
+        if (!tracePath.empty()) saveTrace(tracePath);
+        return exitCode;
+    }
+    if (mode == "--render-stats") {
+        int frames = args.size() > 2 ? std::stoi(std::string(args[2])) : defaultRenderStatsFrames;
+        b2AABB view = cameraView(gameCamera(), {screenWidth, screenHeight});
+        return runRenderStats(levelPath.empty() ? Level::builtin() : loadLevel(levelPath), frames, view, options);
+    }
+    if (mode == "--replay") {
+        if (args.size() < 3) {
+            std::cerr << "usage: " << argv[0] << " --replay <file> [tick]" << std::endl;
+            return 1;
+        }
+        uint64_t fromTick = args.size() > 3 ? std::stoull(std::string(args[3])) : 0;
+        int exitCode = runReplay(args[2], fromTick);
+        if (!tracePath.empty()) saveTrace(tracePath);
+        return exitCode;
+    }
+
+    if (mode == "--record" && !streamLevelPath.empty()) {
+        // streaming depends on how fast chunks come off the disk, which a replay can't reproduce
+        std::cerr << "streamed levels can't be recorded, use " << levelOption << " instead" << std::endl;
+        return 1;
+    }
+
+    // TODO reset button
+    InitWindow(screenWidth, screenHeight, "Rocket Jump!");
+    SetTargetFPS(60);
+
+    Level level = Level::builtin();
+    auto levelStart = std::chrono::steady_clock::now();
+    if (!levelPath.empty()) {
+        level = loadLevel(levelPath);
+    } else if (!streamLevelPath.empty()) {
+        // every wall comes from the streamed level
+        level = Level{};
+    }
+
+    Simulation simulation(1, options, level);
+    if (!streamLevelPath.empty())
+        simulation.streamLevel(ChunkedLevel(streamLevelPath));
+    if (!levelPath.empty() || !streamLevelPath.empty()) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - levelStart;
+        std::cout << "level loaded in " << elapsed.count() << "ms" << std::endl;
+    }
+    std::optional<ReplayWriter> recorder;
+    if (mode == "--record" && args.size() > 2)
+        recorder.emplace(args[2], simulation, REPLAY_DEFAULT_KEYFRAME_INTERVAL, levelPath, level);
 
+    runWindowed(simulation, recorder ? &*recorder : nullptr, tracePath);
+    if (recorder) recorder->finish();
     CloseWindow();
 
     return 0;
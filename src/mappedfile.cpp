@@ -0,0 +1,118 @@
+#include "mappedfile.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(std::string_view path) {
+    HANDLE file = CreateFileA(
+        std::string(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("could not open " + std::string(path));
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("could not read the size of " + std::string(path));
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    // empty files can't be mapped, and don't need to be
+    if (length > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr)
+            bytes = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    // the mapping keeps the file open
+    CloseHandle(file);
+    if (length > 0 && bytes == nullptr) {
+        unmap();
+        throw std::runtime_error("could not map " + std::string(path));
+    }
+}
+
+void MappedFile::unmap() {
+    if (bytes != nullptr)
+        UnmapViewOfFile(bytes);
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+    bytes = nullptr;
+    mapping = nullptr;
+    length = 0;
+}
+
+#else
+
+MappedFile::MappedFile(std::string_view path) {
+    int file = open(std::string(path).c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("could not open " + std::string(path));
+
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        close(file);
+        throw std::runtime_error("could not read the size of " + std::string(path));
+    }
+    length = static_cast<size_t>(status.st_size);
+    // empty files can't be mapped, and don't need to be
+    if (length > 0) {
+        void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+        if (address != MAP_FAILED)
+            bytes = static_cast<const uint8_t *>(address);
+    }
+    // the mapping keeps the file open
+    close(file);
+    if (length > 0 && bytes == nullptr)
+        throw std::runtime_error("could not map " + std::string(path));
+}
+
+void MappedFile::unmap() {
+    if (bytes != nullptr)
+        munmap(const_cast<uint8_t *>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef _WIN32
+        mapping = std::exchange(other.mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+const uint8_t *MappedFile::data() const {
+    return bytes;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
@@ -38,7 +38,8 @@ float recoilImpulse(float chargeProgress) {
 }
 
 struct PlayerAmmoDotPositions {
-    std::array<b2Vec2, Player::maxRockets> dots;
+    // from the player's center, in pixels
+    std::array<Vector2, Player::maxRockets> dots;
     PlayerAmmoDotPositions() {
         using namespace std::complex_literals;
         constexpr std::complex<float> anglePerDot = (2.0if * pi) / static_cast<float>(Player::maxRockets);
@@ -53,7 +54,7 @@ struct PlayerAmmoDotPositions {
             auto complexAngle = pi * -0.5if + static_cast<float>(i) * anglePerDot;
             auto direction = std::exp(complexAngle);
             auto complexPoint = dotsCenter + direction * rocketCountTriangleRadius;
-            dots.at(i) = b2Vec2(complexPoint.real(), complexPoint.imag());
+            dots.at(i) = box2dToRaylib({complexPoint.real(), complexPoint.imag()});
         }
     }
 };
@@ -65,9 +66,9 @@ b2Body *constructPlayerBody(b2World& world, b2Vec2 spawnPosition) {
     return world.CreateBody(&bodyDef);
 }
 
-b2Shape *constructPlayerShape() {
-    b2CircleShape *shape = new b2CircleShape();
-    shape->m_radius = radius;
+b2CircleShape constructPlayerShape() {
+    b2CircleShape shape;
+    shape.m_radius = radius;
     return shape;
 }
 
@@ -78,7 +79,7 @@ b2Fixture *constructPlayerFixture(b2Body *body, b2Shape *shape) {
     return body->CreateFixture(&fixtureDef);
 }
 
-Player::Player(b2World& world, b2Vec2 position):
+Player::Player(b2World& world, b2Vec2 position, size_t explosionCapacity, TimerWheel *timerWheel):
     Entity(
         world,
         constructPlayerBody(world, position),
@@ -87,19 +88,20 @@ Player::Player(b2World& world, b2Vec2 position):
         EntityType::PLAYER,
         EntityType::TERRAIN | EntityType::EXPLOSION
     ),
-    rocketReload(Player::rocketReloadTime, [this](){this->doRocketReload();}),
-    recoilReload(recoilReloadTime),
-    recoilCharge(recoilChargeTime)
+    rocketReload(Player::rocketReloadTime, [this](){this->doRocketReload();}, timerWheel),
+    recoilReload(recoilReloadTime, [](){}, timerWheel),
+    recoilCharge(recoilChargeTime, [](){}, timerWheel),
+    nearbyExplosions(explosionCapacity)
 {
     recoilReload.setToComplete();
+    updateTimersRunning();
 }
 
 // reload: [0, 1]
-void drawAmmoDot(b2Vec2 worldPos, float reload) {
+void drawAmmoDot(RenderCommandBuffer& commands, Vector2 pos, float reload) {
     float filledSectorAngle = -90 + reload * 360;
-    Vector2 pos = box2dToRaylib(worldPos);
-    DrawCircleV(pos, metersToPixels(rocketCountEmptyDotRadius), GRAY);
-    DrawCircleSector(
+    commands.circle(pos, metersToPixels(rocketCountEmptyDotRadius), GRAY);
+    commands.circleSector(
         pos,
         metersToPixels(rocketCountFilledDotRadius),
         -90,
@@ -109,10 +111,9 @@ void drawAmmoDot(b2Vec2 worldPos, float reload) {
     );
 }
 
-void Player::render() const {
-    auto rlPos = raylibPosition();
-    DrawCircleV(rlPos, metersToPixels(radius), RED);
-    b2Vec2 position = box2dPosition();
+void Player::render(RenderCommandBuffer& commands, float alpha) const {
+    auto rlPos = interpolatedRaylibPosition(alpha);
+    commands.circle(rlPos, metersToPixels(radius), RED);
 
     for (int i = 0; i < maxRockets; i++) {
         auto dotRelativePosition = playerAmmoDotPositions.dots.at(i);
@@ -124,18 +125,27 @@ void Player::render() const {
         } else {
             reloadAmount = 0.0f;
         }
-        drawAmmoDot(position + dotRelativePosition, reloadAmount);
+        drawAmmoDot(commands, Vector2Add(rlPos, dotRelativePosition), reloadAmount);
     }
 }
 
+b2AABB Player::renderBounds() const {
+    // ammo dots are above the player
+    constexpr float dotsExtent = radius + rocketCountMarginBottom
+        + 2 * rocketCountTriangleRadius + rocketCountFilledDotRadius;
+    return sweptBounds(dotsExtent);
+}
+
 void Player::updateTimers(float deltaTime) {
-    if (rocketAmmo < Player::maxRockets)
-        rocketReload.update(deltaTime);
-    if (chargingRecoil) {
-        recoilCharge.update(deltaTime);
-    } else {
-        recoilReload.update(deltaTime);
-    }
+    rocketReload.update(deltaTime);
+    recoilCharge.update(deltaTime);
+    recoilReload.update(deltaTime);
+}
+
+void Player::updateTimersRunning() {
+    rocketReload.setRunning(rocketAmmo < Player::maxRockets);
+    recoilCharge.setRunning(chargingRecoil);
+    recoilReload.setRunning(!chargingRecoil);
 }
 
 void Player::update(float deltaTime) {
@@ -158,22 +168,28 @@ void Player::doRocketReload() {
     if (rocketAmmo < Player::maxRockets) {
         rocketAmmo++;
         rocketReload.reset();
+        updateTimersRunning();
     }
 }
 
-Rocket *Player::shootRocketTowards(b2Vec2 target) {
+Rocket *Player::shootRocketTowards(b2Vec2 target, Pool<Rocket>& rocketPool) {
     if (rocketAmmo <= 0)
         return nullptr;
     auto pos = box2dPosition();
     b2Vec2 direction = target - pos;
     direction.Normalize();
-    rocketAmmo--;
-    return new Rocket(world, pos, direction);
+    Rocket *rocket = rocketPool.create(world, pos, direction);
+    if (rocket != nullptr) {
+        rocketAmmo--;
+        updateTimersRunning();
+    }
+    return rocket;
 }
 
 bool Player::startChargingRecoil() {
     if (recoilReload.done()) {
         chargingRecoil = true;
+        updateTimersRunning();
         return true;
     } else {
         return false;
@@ -191,14 +207,44 @@ void Player::recoilFrom(b2Vec2 origin, RecoilWave& recoilWave) {
     recoilWave.moveTo(box2dPosition(), direction);
     recoilCharge.reset();
     recoilReload.reset();
+    updateTimersRunning();
 }
 
-void Player::feelExplosion(const Explosion& explosion) {
+void Player::feelExplosion(b2Vec2 origin, float strength) {
     // this direction approximation is only valid since both the player and
     // the explosions are circles.
     // otherwise we'd need to pass in the contact point as well, to determine
     // the direction
-    b2Vec2 direction = box2dPosition() - explosion.box2dPosition();
+    b2Vec2 direction = box2dPosition() - origin;
     direction.Normalize();
-    body->ApplyForceToCenter(explosion.calculateStrength() * direction, true);
+    body->ApplyForceToCenter(strength * direction, true);
+}
+
+SparseSet& Player::getNearbyExplosions() {
+    return nearbyExplosions;
+}
+
+const SparseSet& Player::getNearbyExplosions() const {
+    return nearbyExplosions;
+}
+
+Player::State Player::saveState() const {
+    return {
+        .body = saveBodyState(),
+        .rocketReload = rocketReload.saveState(),
+        .recoilReload = recoilReload.saveState(),
+        .recoilCharge = recoilCharge.saveState(),
+        .rocketAmmo = rocketAmmo,
+        .chargingRecoil = chargingRecoil,
+    };
+}
+
+void Player::loadState(const State& state) {
+    loadBodyState(state.body);
+    rocketReload.loadState(state.rocketReload);
+    recoilReload.loadState(state.recoilReload);
+    recoilCharge.loadState(state.recoilCharge);
+    rocketAmmo = state.rocketAmmo;
+    chargingRecoil = state.chargingRecoil;
+    updateTimersRunning();
 }
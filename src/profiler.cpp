@@ -0,0 +1,162 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "json11.hpp"
+
+#ifdef RJ_PROFILE
+
+// per thread, about 1.5MB each
+constexpr size_t profileBufferEvents = 1 << 16;
+
+namespace {
+
+uint64_t nowNanoseconds() {
+    auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count();
+}
+
+// fields are atomic so a dump can read them while the owning thread records,
+// relaxed accesses compile to plain moves
+struct ProfileEvent {
+    std::atomic<const char *> name;
+    std::atomic<uint64_t> begin;
+    std::atomic<uint64_t> end;
+};
+
+struct ProfileBuffer {
+    const int threadIndex;
+    // total events ever recorded, the next one goes to written % profileBufferEvents
+    std::atomic<uint64_t> written = 0;
+    // events before this one were already drained, guarded by registryMutex
+    uint64_t drained = 0;
+    std::unique_ptr<ProfileEvent[]> events;
+
+    explicit ProfileBuffer(int threadIndex):
+        threadIndex(threadIndex),
+        events(new ProfileEvent[profileBufferEvents]) {}
+
+    void record(const char *name, uint64_t begin, uint64_t end) {
+        uint64_t index = written.load(std::memory_order_relaxed);
+        // a dump that reads the overwritten event after this fence also sees
+        // `written` from before it, and knows that event may be torn
+        std::atomic_thread_fence(std::memory_order_release);
+        ProfileEvent& event = events[index % profileBufferEvents];
+        event.name.store(name, std::memory_order_relaxed);
+        event.begin.store(begin, std::memory_order_relaxed);
+        event.end.store(end, std::memory_order_relaxed);
+        written.store(index + 1, std::memory_order_release);
+    }
+};
+
+// buffers live until the process exits, so dumps can still read the
+// events of threads that have finished
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ProfileBuffer>> registry;
+
+ProfileBuffer& threadBuffer() {
+    thread_local ProfileBuffer *buffer = [](){
+        std::lock_guard lock(registryMutex);
+        int threadIndex = static_cast<int>(registry.size());
+        return registry.emplace_back(std::make_unique<ProfileBuffer>(threadIndex)).get();
+    }();
+    return *buffer;
+}
+
+// copies the events from `since` on that are still intact, returns the end of the copied range
+uint64_t copyEvents(const ProfileBuffer& buffer, uint64_t since, std::vector<ProfileRecord>& out) {
+    uint64_t end = buffer.written.load(std::memory_order_acquire);
+    uint64_t begin = end > profileBufferEvents ? end - profileBufferEvents : 0;
+    begin = std::clamp(since, begin, end);
+    size_t firstCopied = out.size();
+    for (uint64_t i = begin; i < end; i++) {
+        const ProfileEvent& event = buffer.events[i % profileBufferEvents];
+        out.push_back({
+            .name = event.name.load(std::memory_order_relaxed),
+            .begin = event.begin.load(std::memory_order_relaxed),
+            .end = event.end.load(std::memory_order_relaxed),
+            .threadIndex = buffer.threadIndex,
+        });
+    }
+
+    // drop whatever the thread may have overwritten while it was being copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t writtenAfter = buffer.written.load(std::memory_order_relaxed);
+    uint64_t intactBegin = writtenAfter > profileBufferEvents ? writtenAfter - profileBufferEvents : 0;
+    uint64_t overwritten = std::clamp(intactBegin, begin, end) - begin;
+    out.erase(out.begin() + firstCopied, out.begin() + firstCopied + overwritten);
+    return end;
+}
+
+} // namespace
+
+ProfileScope::ProfileScope(const char *name):
+    name(name),
+    begin(nowNanoseconds()) {}
+
+ProfileScope::~ProfileScope() {
+    threadBuffer().record(name, begin, nowNanoseconds());
+}
+
+void writeChromeTrace(std::ostream& out) {
+    std::vector<ProfileRecord> copied;
+    {
+        std::lock_guard lock(registryMutex);
+        for (const auto& buffer: registry)
+            copyEvents(*buffer, 0, copied);
+    }
+
+    uint64_t origin = UINT64_MAX;
+    for (const ProfileRecord& event: copied)
+        origin = std::min(origin, event.begin);
+
+    json11::Json::array traceEvents;
+    traceEvents.reserve(copied.size());
+    for (const ProfileRecord& event: copied) {
+        // chrome expects microseconds
+        traceEvents.push_back(json11::Json::object{
+            {"name", event.name},
+            {"ph", "X"},
+            {"ts", (event.begin - origin) / 1000.0},
+            {"dur", (event.end - event.begin) / 1000.0},
+            {"pid", 0},
+            {"tid", event.threadIndex},
+        });
+    }
+
+    std::string dump;
+    json11::Json(json11::Json::object{
+        {"traceEvents", traceEvents},
+        {"displayTimeUnit", "ms"},
+    }).dump(dump);
+    out << dump;
+}
+
+uint64_t drainProfileRecords(std::vector<ProfileRecord>& out) {
+    std::lock_guard lock(registryMutex);
+    uint64_t lost = 0;
+    for (const auto& buffer: registry) {
+        size_t copiedBefore = out.size();
+        uint64_t since = buffer->drained;
+        buffer->drained = copyEvents(*buffer, since, out);
+        lost += (buffer->drained - since) - (out.size() - copiedBefore);
+    }
+    return lost;
+}
+
+#else
+
+void writeChromeTrace(std::ostream& out) {
+    out << R"({"traceEvents":[]})";
+}
+
+uint64_t drainProfileRecords(std::vector<ProfileRecord>& out) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include "raylibbackend.hpp"
+
+#include <cmath>
+#include <rlgl.h>
+
+RaylibBackend::~RaylibBackend() {
+    for (auto& [outlines, layer]: layerTextures)
+        UnloadRenderTexture(layer.texture);
+}
+
+void RaylibBackend::draw(const RenderCommandBuffer& commands) {
+    frame++;
+    drawCommands(commands);
+    std::erase_if(layerTextures, [this](const auto& entry) {
+        const LayerTexture& layer = entry.second;
+        if (layer.lastDrawnFrame == frame)
+            return false;
+        UnloadRenderTexture(layer.texture);
+        return true;
+    });
+}
+
+void RaylibBackend::drawCommands(const RenderCommandBuffer& commands) {
+    using Type = RenderCommand::Type;
+    for (const RenderCommand& command: commands.view()) {
+        switch (command.type) {
+            case Type::CIRCLE:
+                DrawCircleV(command.circle.center, command.circle.radius, command.color);
+                break;
+            case Type::CIRCLE_SECTOR:
+                DrawCircleSector(
+                    command.circle.center,
+                    command.circle.radius,
+                    command.circle.startAngle,
+                    command.circle.endAngle,
+                    command.segments,
+                    command.color
+                );
+                break;
+            case Type::CIRCLE_LINES:
+                DrawCircleLinesV(command.circle.center, command.circle.radius, command.color);
+                break;
+            case Type::CIRCLE_SECTOR_LINES:
+                DrawCircleSectorLines(
+                    command.circle.center,
+                    command.circle.radius,
+                    command.circle.startAngle,
+                    command.circle.endAngle,
+                    command.segments,
+                    command.color
+                );
+                break;
+            case Type::TRIANGLE_LINES:
+                DrawTriangleLines(
+                    command.triangle.vertices[0],
+                    command.triangle.vertices[1],
+                    command.triangle.vertices[2],
+                    command.color
+                );
+                break;
+            case Type::RECTANGLE_LINES:
+                // whole pixels, like walls have always been drawn
+                DrawRectangleLines(
+                    command.rectangle.x,
+                    command.rectangle.y,
+                    command.rectangle.width,
+                    command.rectangle.height,
+                    command.color
+                );
+                break;
+            case Type::LINE:
+                DrawLineEx(command.line.start, command.line.end, command.line.thickness, command.color);
+                break;
+            case Type::CACHED_LAYER:
+                drawCachedLayer(commands.getCachedLayer(command));
+                break;
+        }
+    }
+}
+
+void RaylibBackend::drawCachedLayer(const std::shared_ptr<const WallOutlines>& outlines) {
+    const Rectangle& bounds = outlines->bounds;
+    auto [entry, added] = layerTextures.try_emplace(outlines.get());
+    LayerTexture& layer = entry->second;
+    layer.lastDrawnFrame = frame;
+    if (added) {
+        layer.outlines = outlines;
+        layer.texture = LoadRenderTexture(
+            std::ceil(bounds.width * WallLayer::textureScale),
+            std::ceil(bounds.height * WallLayer::textureScale)
+        );
+
+        // texture mode resets the transform of the camera being drawn with
+        Matrix cameraTransform = rlGetMatrixModelview();
+        BeginTextureMode(layer.texture);
+            ClearBackground(BLANK);
+            Camera2D textureCamera = {};
+            textureCamera.target = {bounds.x, bounds.y};
+            textureCamera.zoom = WallLayer::textureScale;
+            BeginMode2D(textureCamera);
+                drawCommands(outlines->commands);
+            EndMode2D();
+        EndTextureMode();
+        rlSetMatrixModelview(cameraTransform);
+    }
+    // render textures are upside down
+    Rectangle source = {
+        0,
+        0,
+        static_cast<float>(layer.texture.texture.width),
+        -static_cast<float>(layer.texture.texture.height)
+    };
+    DrawTexturePro(layer.texture.texture, source, bounds, {0, 0}, 0, WHITE);
+}
@@ -20,15 +20,15 @@ b2Body *constructRecoilWaveBody(b2World& world) {
     return world.CreateBody(&bodyDef);
 }
 
-b2Shape *constructRecoilWaveShape() {
-    b2PolygonShape *shape = new b2PolygonShape();
-    shape->SetAsBox(hitboxDepth * 0.5f, hitboxWidth * 0.5f);
+b2PolygonShape constructRecoilWaveShape() {
+    b2PolygonShape shape;
+    shape.SetAsBox(hitboxDepth * 0.5f, hitboxWidth * 0.5f);
     for (int i = 0; i < 4; i++)
-        shape->m_vertices[i].x -= hitboxOffset;
+        shape.m_vertices[i].x -= hitboxOffset;
     return shape;
 }
 
-RecoilWave::RecoilWave(b2World& world)
+RecoilWave::RecoilWave(b2World& world, TimerWheel *timerWheel)
     : Entity(
         world,
         constructRecoilWaveBody(world),
@@ -37,7 +37,7 @@ RecoilWave::RecoilWave(b2World& world)
         Entity::EntityType::RECOIL_WAVE,
         0
     ),
-    duration(RecoilWave::lifetime, [this](){this->disable();})
+    duration(RecoilWave::lifetime, [this](){this->disable();}, timerWheel)
 {
     duration.setToComplete();
 }
@@ -48,6 +48,8 @@ void RecoilWave::moveTo(b2Vec2 position, b2Vec2 direction) {
     float angle = std::atan2(direction.y, direction.x);
     body->SetEnabled(true);
     body->SetTransform(position, angle);
+    // teleported, don't interpolate from wherever it was last disabled
+    previousPosition = position;
     body->SetLinearVelocity(-speed * direction);
     duration.reset();
 }
@@ -56,18 +58,18 @@ void RecoilWave::update(float deltaTime) {
     duration.update(deltaTime);
 }
 
-void RecoilWave::render() const {
+void RecoilWave::render(RenderCommandBuffer& commands, float alpha) const {
     if (!body->IsEnabled()) return;
-    Vector2 arcCenter = box2dToRaylib(box2dPosition());
-    static float arcRadius = metersToPixels(hitboxOffset);
+    Vector2 arcCenter = interpolatedRaylibPosition(alpha);
+    constexpr float arcRadius = metersToPixels(hitboxOffset);
     float angle = 180.0f + body->GetAngle() * (180.0f / std::numbers::pi);
     Color color = WHITE;
     color.a = duration.timeLeft() * 255;
-    DrawCircleSectorLines(arcCenter, arcRadius, angle - 30, angle + 30, 90, color);
+    commands.circleSectorLines(arcCenter, arcRadius, angle - 30, angle + 30, 90, color);
 
 #ifdef DEBUG
     b2PolygonShape *shape = dynamic_cast<b2PolygonShape*>(fixture->GetShape());
-    b2Vec2 center = box2dPosition();
+    b2Vec2 center = interpolatedBox2dPosition(alpha);
     float s = std::sin(body->GetAngle());
     float c = std::cos(body->GetAngle());
 
@@ -80,11 +82,27 @@ void RecoilWave::render() const {
 
         Vector2 prevPx = box2dToRaylib(center + rotPrevVert);
         Vector2 currPx = box2dToRaylib(center + rotCurrVert);
-        DrawLineEx(prevPx, currPx, 1.0f, RED);
+        commands.line(prevPx, currPx, 1.0f, RED);
     }
 #endif
 }
 
+b2AABB RecoilWave::renderBounds() const {
+    return sweptBounds(hitboxOffset + hitboxWidth);
+}
+
 void RecoilWave::disable() {
     body->SetEnabled(false);
 }
+
+RecoilWave::State RecoilWave::saveState() const {
+    return {
+        .body = saveBodyState(),
+        .duration = duration.saveState(),
+    };
+}
+
+void RecoilWave::loadState(const State& state) {
+    loadBodyState(state.body);
+    duration.loadState(state.duration);
+}
@@ -0,0 +1,175 @@
+#include "rendercommands.hpp"
+
+#include <raymath.h>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+static_assert(sizeof(RenderCommand) == 32, "keep commands small, a frame records thousands");
+
+size_t sortKey(const RenderCommand& command) {
+    return static_cast<size_t>(command.layer) * RenderCommand::typeCount
+        + static_cast<size_t>(command.type);
+}
+
+RenderCommand& RenderCommandBuffer::push(RenderCommand::Type type, Color color) {
+    RenderCommand& command = commands.emplace_back();
+    command.type = type;
+    command.layer = layer;
+    command.segments = 0;
+    command.color = color;
+    return command;
+}
+
+void RenderCommandBuffer::setLayer(RenderLayer layer) {
+    this->layer = layer;
+}
+
+void RenderCommandBuffer::circle(Vector2 center, float radius, Color color) {
+    push(RenderCommand::Type::CIRCLE, color).circle = {center, radius, 0, 0};
+}
+
+void RenderCommandBuffer::circleLines(Vector2 center, float radius, Color color) {
+    push(RenderCommand::Type::CIRCLE_LINES, color).circle = {center, radius, 0, 0};
+}
+
+void RenderCommandBuffer::circleSector(
+    Vector2 center,
+    float radius,
+    float startAngle,
+    float endAngle,
+    int segments,
+    Color color
+) {
+    RenderCommand& command = push(RenderCommand::Type::CIRCLE_SECTOR, color);
+    command.segments = segments;
+    command.circle = {center, radius, startAngle, endAngle};
+}
+
+void RenderCommandBuffer::circleSectorLines(
+    Vector2 center,
+    float radius,
+    float startAngle,
+    float endAngle,
+    int segments,
+    Color color
+) {
+    RenderCommand& command = push(RenderCommand::Type::CIRCLE_SECTOR_LINES, color);
+    command.segments = segments;
+    command.circle = {center, radius, startAngle, endAngle};
+}
+
+void RenderCommandBuffer::triangleLines(Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+    push(RenderCommand::Type::TRIANGLE_LINES, color).triangle = {{v1, v2, v3}};
+}
+
+void RenderCommandBuffer::rectangleLines(Rectangle rectangle, Color color) {
+    push(RenderCommand::Type::RECTANGLE_LINES, color).rectangle = rectangle;
+}
+
+void RenderCommandBuffer::line(Vector2 start, Vector2 end, float thickness, Color color) {
+    push(RenderCommand::Type::LINE, color).line = {start, end, thickness};
+}
+
+void RenderCommandBuffer::cachedLayer(std::shared_ptr<const WallOutlines> outlines) {
+    push(RenderCommand::Type::CACHED_LAYER, WHITE).cachedLayer = cachedLayers.size();
+    cachedLayers.push_back(std::move(outlines));
+}
+
+void RenderCommandBuffer::append(const RenderCommandBuffer& other) {
+    size_t start = commands.size();
+    uint32_t layerOffset = cachedLayers.size();
+    commands.insert(commands.end(), other.commands.begin(), other.commands.end());
+    cachedLayers.insert(cachedLayers.end(), other.cachedLayers.begin(), other.cachedLayers.end());
+    for (size_t i = start; i < commands.size(); i++) {
+        commands[i].layer = layer;
+        if (commands[i].type == RenderCommand::Type::CACHED_LAYER)
+            commands[i].cachedLayer += layerOffset;
+    }
+}
+
+void RenderCommandBuffer::sort() {
+    // a counting sort, there are few keys and it keeps equal ones in order
+    std::array<uint32_t, renderLayerCount * RenderCommand::typeCount> offsets = {};
+    for (const RenderCommand& command: commands)
+        offsets[sortKey(command)]++;
+    uint32_t offset = 0;
+    for (uint32_t& keyOffset: offsets)
+        offset += std::exchange(keyOffset, offset);
+
+    sorted.resize(commands.size());
+    for (const RenderCommand& command: commands)
+        sorted[offsets[sortKey(command)]++] = command;
+    commands.swap(sorted);
+}
+
+void RenderCommandBuffer::clear() {
+    commands.clear();
+    cachedLayers.clear();
+    layer = RenderLayer::EXPLOSIONS;
+}
+
+void RenderCommandBuffer::interpolate(const RenderCommandBuffer& from, const RenderCommandBuffer& to, float alpha) {
+    commands = to.commands;
+    cachedLayers = to.cachedLayers;
+    layer = to.layer;
+    // checked up front so a mismatch can't leave some commands moved and others not
+    if (from.commands.size() != to.commands.size())
+        return;
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (from.commands[i].type != commands[i].type)
+            return;
+    }
+
+    for (size_t i = 0; i < commands.size(); i++) {
+        const RenderCommand& start = from.commands[i];
+        RenderCommand& command = commands[i];
+        // only positions, everything else was recorded from the same state
+        switch (command.type) {
+            case RenderCommand::Type::CIRCLE:
+            case RenderCommand::Type::CIRCLE_SECTOR:
+            case RenderCommand::Type::CIRCLE_LINES:
+            case RenderCommand::Type::CIRCLE_SECTOR_LINES:
+                command.circle.center = Vector2Lerp(start.circle.center, command.circle.center, alpha);
+                break;
+            case RenderCommand::Type::TRIANGLE_LINES:
+                for (int vertex = 0; vertex < 3; vertex++) {
+                    command.triangle.vertices[vertex] = Vector2Lerp(
+                        start.triangle.vertices[vertex],
+                        command.triangle.vertices[vertex],
+                        alpha
+                    );
+                }
+                break;
+            case RenderCommand::Type::RECTANGLE_LINES:
+                command.rectangle.x = Lerp(start.rectangle.x, command.rectangle.x, alpha);
+                command.rectangle.y = Lerp(start.rectangle.y, command.rectangle.y, alpha);
+                break;
+            case RenderCommand::Type::LINE:
+                command.line.start = Vector2Lerp(start.line.start, command.line.start, alpha);
+                command.line.end = Vector2Lerp(start.line.end, command.line.end, alpha);
+                break;
+            case RenderCommand::Type::CACHED_LAYER:
+                break;
+        }
+    }
+}
+
+std::span<const RenderCommand> RenderCommandBuffer::view() const {
+    return commands;
+}
+
+size_t RenderCommandBuffer::size() const {
+    return commands.size();
+}
+
+const std::shared_ptr<const WallOutlines>& RenderCommandBuffer::getCachedLayer(const RenderCommand& command) const {
+    return cachedLayers.at(command.cachedLayer);
+}
+
+size_t RenderCommandBuffer::count(RenderCommand::Type type) const {
+    return std::count_if(commands.begin(), commands.end(), [type](const RenderCommand& command) {
+        return command.type == type;
+    });
+}
@@ -0,0 +1,290 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "world.hpp"
+#include "bytebuffer.hpp"
+
+constexpr char headerMagic[4] = {'R', 'J', 'R', 'P'};
+constexpr char footerMagic[4] = {'R', 'J', 'I', 'X'};
+constexpr uint16_t replayVersion = 6;
+
+enum Buttons: uint8_t {
+    LEFT_PRESSED = 0x01,
+    LEFT_RELEASED = 0x02,
+    RIGHT_PRESSED = 0x04,
+    RIGHT_RELEASED = 0x08,
+};
+
+uint8_t encodeButtons(const TickInput& input) {
+    uint8_t buttons = 0;
+    if (input.leftPressed) buttons |= Buttons::LEFT_PRESSED;
+    if (input.leftReleased) buttons |= Buttons::LEFT_RELEASED;
+    if (input.rightPressed) buttons |= Buttons::RIGHT_PRESSED;
+    if (input.rightReleased) buttons |= Buttons::RIGHT_RELEASED;
+    return buttons;
+}
+
+template<typename T>
+T readPod(std::istream& in) {
+    T value;
+    in.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+}
+
+uint64_t readVarint(std::istream& in) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        auto byte = readPod<uint8_t>(in);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    throw std::runtime_error("replay has a malformed varint");
+}
+
+ReplayWriter::ReplayWriter(
+    std::string_view path,
+    Simulation& simulation,
+    uint32_t keyframeInterval,
+    std::string_view levelPath,
+    const Level& level
+):
+    file(std::string(path), std::ios::binary | std::ios::trunc),
+    keyframeInterval(keyframeInterval),
+    currentTick(simulation.tick())
+{
+    if (!file)
+        throw std::runtime_error("could not open replay for writing");
+    if (keyframeInterval == 0 || simulation.tick() % keyframeInterval != 0)
+        throw std::invalid_argument("recording must start at a keyframe tick");
+    if (levelPath.size() > UINT16_MAX)
+        throw std::invalid_argument("level path is too long to be recorded");
+    file.exceptions(std::ios::failbit | std::ios::badbit);
+
+    ByteWriter writer(buffer);
+    for (char c: headerMagic)
+        writer.put(c);
+    writer.put(replayVersion);
+    writer.put(static_cast<uint16_t>(simulation.playerCount()));
+    writer.put(SIMULATION_STEP_INTERVAL);
+    writer.put(keyframeInterval);
+    writer.put(simulation.getOptions().explosionDetection);
+    writer.put(simulation.getOptions().timerWheel);
+    writer.put(level.hash());
+    writer.put(static_cast<uint16_t>(levelPath.size()));
+    buffer.insert(buffer.end(), levelPath.begin(), levelPath.end());
+    writeBuffer();
+
+    writeKeyframe(simulation);
+}
+
+ReplayWriter::~ReplayWriter() {
+    try {
+        finish();
+    } catch (const std::ios_base::failure&) {
+        // nothing sensible left to do with a broken file
+    }
+}
+
+void ReplayWriter::writeBuffer() {
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+    buffer.clear();
+}
+
+void ReplayWriter::writeKeyframe(Simulation& simulation) {
+    index.emplace_back(simulation.tick(), static_cast<uint64_t>(file.tellp()));
+
+    // a snapshot rather than saveState(), it has everything rebuildWorld() rebuilds from
+    simulation.saveSnapshot(keyframe);
+    ByteWriter writer(buffer);
+    writer.put(uint8_t(2));
+    writer.put(simulation.tick());
+    writer.put(static_cast<uint32_t>(keyframe.size()));
+    buffer.insert(buffer.end(), keyframe.data(), keyframe.data() + keyframe.size());
+    writeBuffer();
+    // playbacks seeking here start from a rebuilt world
+    simulation.rebuildWorld();
+
+    lastRecordTick = simulation.tick();
+}
+
+void ReplayWriter::recordInput(
+    const Simulation& simulation,
+    size_t playerIndex,
+    const TickInput& input
+) {
+    uint8_t buttons = encodeButtons(input);
+    // the target is only relevant when a button changed
+    if (buttons == 0 || finished) return;
+
+    ByteWriter writer(buffer);
+    writer.put(uint8_t(1));
+    writer.putVarint(simulation.tick() - lastRecordTick);
+    writer.putVarint(playerIndex);
+    writer.put(buttons);
+    writer.put(input.target.x);
+    writer.put(input.target.y);
+    writeBuffer();
+
+    lastRecordTick = simulation.tick();
+}
+
+void ReplayWriter::afterStep(Simulation& simulation) {
+    currentTick = simulation.tick();
+    if (!finished && currentTick % keyframeInterval == 0)
+        writeKeyframe(simulation);
+}
+
+void ReplayWriter::finish() {
+    if (finished) return;
+    finished = true;
+
+    ByteWriter writer(buffer);
+    writer.put(uint8_t(3));
+    writer.put(currentTick);
+    uint64_t indexOffset = static_cast<uint64_t>(file.tellp()) + buffer.size();
+    writer.put(static_cast<uint64_t>(index.size()));
+    for (auto [tick, offset]: index) {
+        writer.put(tick);
+        writer.put(offset);
+    }
+    writer.put(indexOffset);
+    for (char c: footerMagic)
+        writer.put(c);
+    writeBuffer();
+    file.close();
+}
+
+ReplayReader::ReplayReader(std::string_view path):
+    file(std::string(path), std::ios::binary)
+{
+    if (!file)
+        throw std::runtime_error("could not open replay");
+    file.exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
+
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    if (std::memcmp(magic, headerMagic, sizeof(magic)) != 0)
+        throw std::runtime_error("not a replay file");
+    if (readPod<uint16_t>(file) != replayVersion)
+        throw std::runtime_error("unsupported replay version");
+    players = readPod<uint16_t>(file);
+    if (readPod<float>(file) != SIMULATION_STEP_INTERVAL)
+        throw std::runtime_error("replay was recorded with a different step interval");
+    keyframeInterval = readPod<uint32_t>(file);
+    options.explosionDetection = readPod<ExplosionDetection>(file);
+    options.timerWheel = readPod<bool>(file);
+    levelHash = readPod<uint64_t>(file);
+    levelPath.resize(readPod<uint16_t>(file));
+    file.read(levelPath.data(), levelPath.size());
+
+    file.seekg(-static_cast<std::streamoff>(sizeof(uint64_t) + sizeof(footerMagic)), std::ios::end);
+    auto indexOffset = readPod<uint64_t>(file);
+    file.read(magic, sizeof(magic));
+    if (std::memcmp(magic, footerMagic, sizeof(magic)) != 0)
+        throw std::runtime_error("replay has no index, recording was not finished");
+
+    // END record sits right before the index
+    file.seekg(indexOffset - sizeof(uint64_t));
+    totalTicks = readPod<uint64_t>(file);
+    index.resize(readPod<uint64_t>(file));
+    for (auto& [tick, offset]: index) {
+        tick = readPod<uint64_t>(file);
+        offset = readPod<uint64_t>(file);
+    }
+    if (index.empty())
+        throw std::runtime_error("replay has no keyframes");
+}
+
+uint64_t ReplayReader::length() const {
+    return totalTicks;
+}
+
+size_t ReplayReader::playerCount() const {
+    return players;
+}
+
+const SimulationOptions& ReplayReader::getSimulationOptions() const {
+    return options;
+}
+
+Level ReplayReader::loadRecordedLevel() const {
+    Level level = levelPath.empty() ? Level::builtin() : loadLevel(levelPath);
+    if (level.hash() != levelHash)
+        throw std::runtime_error("replay was recorded on a different level");
+    return level;
+}
+
+void ReplayReader::readRecord() {
+    auto kind = readPod<Record::Kind>(file);
+    switch (kind) {
+    case Record::INPUT: {
+        next.tick += readVarint(file);
+        next.playerIndex = readVarint(file);
+        auto buttons = readPod<uint8_t>(file);
+        next.input.leftPressed = buttons & Buttons::LEFT_PRESSED;
+        next.input.leftReleased = buttons & Buttons::LEFT_RELEASED;
+        next.input.rightPressed = buttons & Buttons::RIGHT_PRESSED;
+        next.input.rightReleased = buttons & Buttons::RIGHT_RELEASED;
+        next.input.target.x = readPod<float>(file);
+        next.input.target.y = readPod<float>(file);
+        break;
+    }
+    case Record::KEYFRAME:
+        // already simulated up to here, only the world has to be rebuilt
+        next.tick = readPod<uint64_t>(file);
+        file.seekg(readPod<uint32_t>(file), std::ios::cur);
+        break;
+    case Record::END:
+        next.tick = readPod<uint64_t>(file);
+        break;
+    default:
+        throw std::runtime_error("replay has an unknown record");
+    }
+    next.kind = kind;
+}
+
+void ReplayReader::loadKeyframe(Simulation& simulation) {
+    if (readPod<Record::Kind>(file) != Record::KEYFRAME)
+        throw std::runtime_error("replay index does not point to a keyframe");
+    next.tick = readPod<uint64_t>(file);
+    buffer.resize(readPod<uint32_t>(file));
+    file.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+    keyframe.assign(buffer.data(), buffer.size());
+    simulation.loadSnapshot(keyframe);
+    simulation.rebuildWorld();
+}
+
+void ReplayReader::seek(Simulation& simulation, uint64_t tick) {
+    if (tick > totalTicks)
+        tick = totalTicks;
+    // recording may have started at a later keyframe than tick 0
+    uint64_t firstTick = index.front().first;
+    if (tick < firstTick)
+        tick = firstTick;
+    size_t keyframe = std::min<size_t>((tick - firstTick) / keyframeInterval, index.size() - 1);
+    file.seekg(index.at(keyframe).second);
+    loadKeyframe(simulation);
+    readRecord();
+
+    while (simulation.tick() < tick) {
+        applyInputs(simulation);
+        simulation.step();
+    }
+}
+
+void ReplayReader::applyInputs(Simulation& simulation) {
+    while (next.kind != Record::END && next.tick <= simulation.tick()) {
+        if (next.tick == simulation.tick()) {
+            // the recording rebuilt its world right after the keyframe, before any input
+            if (next.kind == Record::KEYFRAME)
+                simulation.rebuildWorld();
+            else if (next.kind == Record::INPUT)
+                simulation.applyInput(next.playerIndex, next.input);
+        }
+        readRecord();
+    }
+}
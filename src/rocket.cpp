@@ -1,4 +1,7 @@
 #include "rocket.hpp"
+
+#include <numbers>
+
 #include "world.hpp"
 
 constexpr float radius = 0.5f;
@@ -20,9 +23,9 @@ b2Body *constructRocketBody(b2World& world, b2Vec2 position, b2Vec2 direction) {
     return world.CreateBody(&bodyDef);
 }
 
-b2Shape *constructRocketShape() {
-    b2CircleShape *shape = new b2CircleShape();
-    shape->m_radius = radius;
+b2CircleShape constructRocketShape() {
+    b2CircleShape shape;
+    shape.m_radius = radius;
     return shape;
 }
 
@@ -41,7 +44,7 @@ Rocket::Rocket(b2World& world, b2Vec2 position, b2Vec2 direction)
 
     this->direction.Normalize();
 
-    static const float halfRoot3 = 0.5f * sqrtf(3.0f);
+    constexpr float halfRoot3 = 0.5f * std::numbers::sqrt3_v<float>;
 
     // head
     auto v1 = triangleToRadiusRatio * radius * direction;
@@ -52,23 +55,27 @@ Rocket::Rocket(b2World& world, b2Vec2 position, b2Vec2 direction)
     };
     // last vertex
     auto v3 = -(v1 + v2);
-    localCoordsVertices.at(0) = v1;
-    localCoordsVertices.at(1) = v2;
-    localCoordsVertices.at(2) = v3;
+    pixelVertices.at(0) = box2dToRaylib(v1);
+    pixelVertices.at(1) = box2dToRaylib(v2);
+    pixelVertices.at(2) = box2dToRaylib(v3);
 }
 
-void Rocket::render() const {
-    auto pos = box2dPosition();
-    auto r1 = box2dToRaylib(pos + localCoordsVertices.at(0));
-    auto r2 = box2dToRaylib(pos + localCoordsVertices.at(1));
-    auto r3 = box2dToRaylib(pos + localCoordsVertices.at(2));
-    DrawTriangleLines(r1, r3, r2, BLUE);
+void Rocket::render(RenderCommandBuffer& commands, float alpha) const {
+    Vector2 center = interpolatedRaylibPosition(alpha);
+    auto r1 = Vector2Add(center, pixelVertices.at(0));
+    auto r2 = Vector2Add(center, pixelVertices.at(1));
+    auto r3 = Vector2Add(center, pixelVertices.at(2));
+    commands.triangleLines(r1, r3, r2, BLUE);
 
 #ifdef DEBUG
-    DrawCircleLinesV(raylibPosition(), metersToPixels(radius), WHITE);
+    commands.circleLines(center, metersToPixels(radius), WHITE);
 #endif
 }
 
+b2AABB Rocket::renderBounds() const {
+    return sweptBounds(triangleToRadiusRatio * radius);
+}
+
 void Rocket::update(float deltaTime) {
     remainingTime -= deltaTime;
 }
@@ -84,3 +91,24 @@ bool Rocket::hasExploded() const {
 void Rocket::collide() {
     wasDestroyed = true;
 }
+
+b2Vec2 Rocket::getDirection() const {
+    return direction;
+}
+
+Rocket::State Rocket::saveState() const {
+    return {
+        .body = saveBodyState(),
+        .direction = direction,
+        .remainingTime = remainingTime,
+        .wasDestroyed = wasDestroyed,
+    };
+}
+
+void Rocket::loadState(const State& state) {
+    loadBodyState(state.body);
+    // normalizing again in the constructor can be off by an ulp
+    direction = state.direction;
+    remainingTime = state.remainingTime;
+    wasDestroyed = state.wasDestroyed;
+}
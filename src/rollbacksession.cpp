@@ -0,0 +1,228 @@
+#include "rollbacksession.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "bytebuffer.hpp"
+#include "profiler.hpp"
+
+/*
+ * Packet layout, all values in native byte order:
+ *
+ *   u64 ack: the next tick the sender is missing input for
+ *   u8 has checksum, u64 checksum tick, u64 checksum
+ *   u64 first tick, u16 count, count * TickInput: every input the receiver
+ *       hasn't acknowledged yet, so lost packets are covered by the next one
+ */
+
+// the remote player is predicted to keep aiming the same way, without
+// pressing or releasing anything
+TickInput predictFrom(const TickInput& last) {
+    TickInput prediction;
+    prediction.target = last.target;
+    return prediction;
+}
+
+RollbackSession::RollbackSession(
+    Simulation& simulation,
+    size_t localPlayer,
+    Transport& transport,
+    RollbackOptions options
+):
+    simulation(simulation),
+    transport(transport),
+    options(options),
+    startTick(simulation.tick()),
+    localPlayer(localPlayer),
+    remotePlayer(1 - localPlayer),
+    localInputs(inputHistory),
+    remoteInputs(inputHistory),
+    // a misprediction maxRollbackTicks back goes back to the rebuild before it
+    snapshots(options.maxRollbackTicks + options.rebuildInterval),
+    // neither player has input for the first inputDelay ticks, both
+    // sides know it without being told
+    localNext(simulation.tick() + options.inputDelay),
+    localAcked(simulation.tick()),
+    remoteReceived(simulation.tick() + options.inputDelay)
+{
+    if (simulation.playerCount() != 2 || localPlayer > 1)
+        throw std::invalid_argument("rollback sessions are between exactly two players");
+    if (options.checksumInterval == 0 || options.rebuildInterval == 0)
+        throw std::invalid_argument("checksum and rebuild intervals must be positive");
+    // the peer can run maxRollbackTicks + inputDelay past us, and we keep
+    // as much behind, plus the way back to a rebuilt tick
+    if (2 * (options.maxRollbackTicks + options.inputDelay) + options.rebuildInterval >= inputHistory)
+        throw std::invalid_argument("input delay and rollback window don't fit in the input history");
+    nextChecksumTick = simulation.tick();
+}
+
+bool RollbackSession::advance(const TickInput& localInput) {
+    uint64_t rollbackTo = UINT64_MAX;
+    receivePackets(rollbackTo);
+    if (rollbackTo < simulation.tick())
+        rollback(rollbackTo);
+
+    // a stalled tick was saved already, and its world rebuilt
+    if (snapshotTick != simulation.tick())
+        saveSnapshot();
+    updateChecksums();
+
+    // running further ahead would leave mispredictions older than the snapshots
+    bool tooFarAhead = simulation.tick() - std::min(remoteReceived, simulation.tick()) >= options.maxRollbackTicks;
+    bool historyFull = localNext - localAcked >= inputHistory;
+    if (tooFarAhead || historyFull) {
+        stats.stalls++;
+        sendPacket();
+        return false;
+    }
+
+    localInputs[localNext % inputHistory] = localInput;
+    localNext++;
+    stepWithInputs();
+    sendPacket();
+    return true;
+}
+
+uint64_t RollbackSession::confirmedTick() const {
+    return std::min(remoteReceived, simulation.tick());
+}
+
+std::optional<uint64_t> RollbackSession::desyncTick() const {
+    return firstDesync;
+}
+
+const RollbackSession::Stats& RollbackSession::getStats() const {
+    return stats;
+}
+
+void RollbackSession::receivePackets(uint64_t& rollbackTo) {
+    while (transport.receive(packet)) {
+        try {
+            readPacket(rollbackTo);
+        } catch (const std::out_of_range&) {
+            // truncated, nothing after the broken part can be trusted but
+            // whatever was read before it is still valid
+        }
+    }
+}
+
+void RollbackSession::readPacket(uint64_t& rollbackTo) {
+    ByteReader reader(packet.data(), packet.size());
+    localAcked = std::clamp(reader.get<uint64_t>(), localAcked, localNext);
+
+    if (reader.get<uint8_t>()) {
+        Checksum checksum;
+        checksum.tick = reader.get<uint64_t>();
+        checksum.value = reader.get<uint64_t>();
+        remoteChecksums[checksum.tick / options.checksumInterval % checksumHistory] = checksum;
+        compareChecksums(checksum.tick);
+    }
+
+    auto firstTick = reader.get<uint64_t>();
+    auto count = reader.get<uint16_t>();
+    // slots older than this may still be needed to resimulate
+    uint64_t oldestKept = oldestSnapshotTick();
+    for (uint64_t tick = firstTick; tick < firstTick + count; tick++) {
+        auto input = reader.get<TickInput>();
+        // older ticks are known already, newer ones would leave a gap
+        if (tick != remoteReceived) continue;
+        if (tick >= oldestKept + inputHistory) break;
+
+        TickInput& stored = remoteInputs[tick % inputHistory];
+        if (tick < simulation.tick() && !(stored == input))
+            rollbackTo = std::min(rollbackTo, tick);
+        stored = input;
+        remoteReceived++;
+    }
+}
+
+void RollbackSession::sendPacket() {
+    packet.clear();
+    ByteWriter writer(packet);
+    writer.put(remoteReceived);
+
+    writer.put<uint8_t>(latestLocalChecksum.tick != UINT64_MAX);
+    if (latestLocalChecksum.tick != UINT64_MAX) {
+        writer.put(latestLocalChecksum.tick);
+        writer.put(latestLocalChecksum.value);
+    }
+
+    writer.put(localAcked);
+    writer.put(static_cast<uint16_t>(localNext - localAcked));
+    for (uint64_t tick = localAcked; tick < localNext; tick++)
+        writer.put(localInputs[tick % inputHistory]);
+    transport.send(packet);
+}
+
+void RollbackSession::rollback(uint64_t tick) {
+    RJ_PROFILE_SCOPE("rollback");
+    // only rebuilt worlds step the same however the simulation got there
+    tick -= (tick - startTick) % options.rebuildInterval;
+    uint32_t depth = static_cast<uint32_t>(simulation.tick() - tick);
+    stats.rollbacks++;
+    stats.resimulatedTicks += depth;
+    stats.maxRollbackDepth = std::max(stats.maxRollbackDepth, depth);
+
+    uint64_t presentTick = simulation.tick();
+    // a stall may have saved the present already, from before the misprediction was known
+    snapshotTick = UINT64_MAX;
+    simulation.loadSnapshot(snapshots[tick % snapshots.size()]);
+    simulation.rebuildWorld();
+    stepWithInputs();
+    while (simulation.tick() < presentTick) {
+        saveSnapshot();
+        stepWithInputs();
+    }
+}
+
+void RollbackSession::stepWithInputs() {
+    uint64_t tick = simulation.tick();
+    TickInput& remoteInput = remoteInputs[tick % inputHistory];
+    if (tick >= remoteReceived) {
+        remoteInput = remoteReceived > 0
+            ? predictFrom(remoteInputs[(remoteReceived - 1) % inputHistory])
+            : TickInput{};
+    }
+    simulation.applyInput(localPlayer, localInputs[tick % inputHistory]);
+    simulation.applyInput(remotePlayer, remoteInput);
+    simulation.step();
+}
+
+void RollbackSession::saveSnapshot() {
+    uint64_t tick = simulation.tick();
+    simulation.saveSnapshot(snapshots[tick % snapshots.size()]);
+    snapshotTick = tick;
+    // so the tick steps the same whether it's resimulated from the snapshot or not
+    if ((tick - startTick) % options.rebuildInterval == 0)
+        simulation.rebuildWorld();
+}
+
+uint64_t RollbackSession::oldestSnapshotTick() const {
+    return simulation.tick() - std::min<uint64_t>(simulation.tick(), snapshots.size() - 1);
+}
+
+void RollbackSession::updateChecksums() {
+    // only snapshots of ticks that only ever saw confirmed input are
+    // compared, the peer's prediction errors would show up otherwise
+    uint64_t oldestSnapshot = oldestSnapshotTick();
+    while (nextChecksumTick <= confirmedTick()) {
+        uint64_t tick = nextChecksumTick;
+        nextChecksumTick += options.checksumInterval;
+        // skipped ticks are no longer in the ring, the next ones will do
+        if (tick < oldestSnapshot) continue;
+
+        Checksum checksum = {tick, snapshots[tick % snapshots.size()].checksum()};
+        localChecksums[tick / options.checksumInterval % checksumHistory] = checksum;
+        latestLocalChecksum = checksum;
+        compareChecksums(tick);
+    }
+}
+
+void RollbackSession::compareChecksums(uint64_t tick) {
+    size_t slot = tick / options.checksumInterval % checksumHistory;
+    const Checksum& local = localChecksums[slot];
+    const Checksum& remote = remoteChecksums[slot];
+    if (local.tick != tick || remote.tick != tick || local.value == remote.value) return;
+    if (!firstDesync || tick < *firstDesync)
+        firstDesync = tick;
+}
@@ -0,0 +1,471 @@
+#include "simulation.hpp"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "world.hpp"
+#include "bytebuffer.hpp"
+#include "hash.hpp"
+#include "profiler.hpp"
+
+constexpr float playerSpawnSpacing = 3.0f;
+
+// what maxExplosionsPerPlayer relies on
+static_assert(Player::rocketReloadTime > Rocket::lifetime + SIMULATION_STEP_INTERVAL + ExplosionSystem::lifetime);
+
+// states are copied to snapshots as raw bytes, any implicit padding in them
+// would make equal states compare unequal
+static_assert(sizeof(Entity::BodyState) == 28);
+static_assert(sizeof(Timer::State) == 8);
+static_assert(sizeof(Player::State) == sizeof(Entity::BodyState) + 3 * sizeof(Timer::State) + 8);
+static_assert(sizeof(Rocket::State) == sizeof(Entity::BodyState) + 16);
+static_assert(sizeof(RecoilWave::State) == sizeof(Entity::BodyState) + sizeof(Timer::State));
+
+// snapshot layout: header, one PlayerSnapshot per player each followed by
+// its nearby explosion slots, then the ExplosionSystem
+struct SnapshotHeader {
+    uint64_t tick;
+    uint32_t playerCount;
+    uint32_t explosionCapacity;
+};
+
+struct PlayerSnapshot {
+    Player::State player;
+    RecoilWave::State recoilWave;
+    std::array<Rocket::State, Player::maxRockets> rockets;
+    int32_t rocketIndex;
+    uint32_t rocketMask;
+    // followed by explosionCapacity slots, the first nearbyExplosionCount
+    // of them in the set's iteration order, which forces are applied in
+    uint32_t nearbyExplosionCount;
+};
+static_assert(sizeof(PlayerSnapshot) == sizeof(Player::State) + sizeof(RecoilWave::State)
+    + Player::maxRockets * sizeof(Rocket::State) + 3 * sizeof(uint32_t));
+
+Simulation::PlayerEntities::PlayerEntities(
+    b2World& world,
+    b2Vec2 position,
+    size_t explosionCapacity,
+    TimerWheel *timerWheel
+):
+    player(world, position, explosionCapacity, timerWheel),
+    recoilWave(world, timerWheel),
+    rockets{} {}
+
+Simulation::Simulation(size_t playerCount, SimulationOptions options, const Level& level):
+    options(options),
+    world(b2Vec2{0.0f, 20.0f}),
+    rocketPool(Player::maxRockets * playerCount),
+    explosions(world, Simulation::maxExplosionsPerPlayer * playerCount, options.explosionDetection),
+    contactListener(explosions)
+{
+    for (const WallDefinition& wall: level.walls)
+        addWall(wall.position, wall.dimensions);
+    if (options.timerWheel)
+        timerWheel.emplace(SIMULATION_STEP_INTERVAL);
+    TimerWheel *playerTimerWheel = timerWheel ? &*timerWheel : nullptr;
+
+    // centered around the origin, a single player spawns right at it
+    float firstSpawnX = -0.5f * playerSpawnSpacing * (playerCount - 1);
+    for (size_t i = 0; i < playerCount; i++) {
+        b2Vec2 spawn = {firstSpawnX + playerSpawnSpacing * i, 0};
+        players.emplace_back(world, spawn, explosions.capacity(), playerTimerWheel);
+    }
+    world.SetContactListener(&contactListener);
+}
+
+Simulation::~Simulation() {
+    // bodies destroyed from now on must not report contacts to a listener
+    // that refers to half-destroyed state
+    // the pools destroy whatever is still alive
+    world.SetContactListener(nullptr);
+}
+
+void Simulation::addWall(b2Vec2 position, b2Vec2 dimensions) {
+    walls.emplace_back(world, position, dimensions);
+    wallLayer.invalidate();
+}
+
+void Simulation::streamLevel(ChunkedLevel level, LevelStreamingOptions streamingOptions) {
+    levelStreamer.emplace(world, std::move(level), streamingOptions);
+    updateLevelStreaming();
+    levelStreamer->finishLoading();
+}
+
+void Simulation::updateLevelStreaming() {
+    RJ_PROFILE_SCOPE("streamLevel");
+    streamingFocus.clear();
+    for (const PlayerEntities& entities: players)
+        streamingFocus.push_back(entities.player.box2dPosition());
+    levelStreamer->update(streamingFocus);
+}
+
+template<typename F>
+void Simulation::forEachEntity(F&& function) {
+    for (Wall& wall: walls)
+        function(wall);
+    if (levelStreamer)
+        levelStreamer->forEachWall(function);
+    for (PlayerEntities& entities: players) {
+        function(entities.player);
+        function(entities.recoilWave);
+        for (Rocket *rocket: entities.rockets) {
+            if (rocket != nullptr)
+                function(*rocket);
+        }
+    }
+    explosions.forEachBody(function);
+}
+
+void Simulation::feelNearbyExplosions(Player& player) {
+    for (uint32_t slot: player.getNearbyExplosions())
+        player.feelExplosion(explosions.positionAt(slot), explosions.strengthAt(slot));
+}
+
+void Simulation::updatePlayers() {
+    RJ_PROFILE_SCOPE("updatePlayers");
+    for (PlayerEntities& entities: players) {
+        Player& player = entities.player;
+        feelNearbyExplosions(player);
+        if (!timerWheel)
+            player.update(SIMULATION_STEP_INTERVAL);
+    }
+    // only visits the timers that expire this step, whatever the player count
+    if (timerWheel)
+        timerWheel->advance();
+}
+
+void Simulation::updateRockets() {
+    RJ_PROFILE_SCOPE("updateRockets");
+    for (PlayerEntities& entities: players) {
+        for (Rocket *rocket: entities.rockets) {
+            if (rocket != nullptr) {
+                rocket->update(SIMULATION_STEP_INTERVAL);
+                if (rocket->shouldExplodeByAge())
+                    explosions.spawn(rocket->box2dPosition());
+            }
+        }
+    }
+    contactListener.flushQueuedExplosions();
+    for (PlayerEntities& entities: players) {
+        for (Rocket *&rocketRef: entities.rockets) {
+            if (rocketRef != nullptr && rocketRef->hasExploded()) {
+                rocketPool.destroy(rocketRef);
+                rocketRef = nullptr;
+            }
+        }
+    }
+}
+
+void Simulation::applyInput(size_t playerIndex, const TickInput& input) {
+    PlayerEntities& entities = players.at(playerIndex);
+    Player& player = entities.player;
+
+    if (input.leftPressed) {
+        Rocket *newRocket = player.shootRocketTowards(input.target, rocketPool);
+        if (newRocket != nullptr) {
+            entities.rockets.at(entities.rocketIndex) = newRocket;
+            entities.rocketIndex = (entities.rocketIndex + 1) % Player::maxRockets;
+        }
+    }
+
+    if (input.rightPressed) {
+        player.startChargingRecoil();
+    }
+
+    if (input.rightReleased) {
+        player.recoilFrom(input.target, entities.recoilWave);
+    }
+}
+
+void Simulation::savePreviousPositions() {
+    for (PlayerEntities& entities: players) {
+        entities.player.savePreviousPosition();
+        for (Rocket *rocket: entities.rockets) {
+            if (rocket != nullptr)
+                rocket->savePreviousPosition();
+        }
+        entities.recoilWave.savePreviousPosition();
+    }
+}
+
+void Simulation::step() {
+    RJ_PROFILE_SCOPE("step");
+    // the only point where bodies can be created before the world steps
+    if (levelStreamer)
+        updateLevelStreaming();
+    savePreviousPositions();
+    if (nearbyExplosionsRestored) {
+        // before the world step, which is when Box2D would have ended them
+        for (PlayerEntities& entities: players)
+            contactListener.dropUnreachedExplosions(entities.player);
+        nearbyExplosionsRestored = false;
+    }
+    {
+        RJ_PROFILE_SCOPE("worldStep");
+        world.Step(SIMULATION_STEP_INTERVAL, SIMULATION_VELOCITY_ITER, SIMULATION_POSITION_ITER);
+    }
+    {
+        RJ_PROFILE_SCOPE("updateExplosions");
+        // process explosions first to allow frame-1-explosion interactions to happen
+        explosions.update(SIMULATION_STEP_INTERVAL);
+    }
+    if (options.explosionDetection == ExplosionDetection::QUERIES) {
+        // after the update, so explosions that just ended aren't felt
+        for (PlayerEntities& entities: players)
+            entities.player.getNearbyExplosions().clear();
+        contactListener.queryExplosionOverlaps(world);
+    }
+    updatePlayers();
+    updateRockets();
+    if (!timerWheel) {
+        RJ_PROFILE_SCOPE("updateRecoilWaves");
+        for (PlayerEntities& entities: players)
+            entities.recoilWave.update(SIMULATION_STEP_INTERVAL);
+    }
+    currentTick++;
+}
+
+void Simulation::render(RenderCommandBuffer& commands, float alpha, const b2AABB *view) const {
+    RJ_PROFILE_SCOPE("renderSimulation");
+    // bounds cover both steps, so whatever alpha is, the same entities are recorded
+    auto inView = [view](const b2AABB& bounds) {
+        return view == nullptr || b2TestOverlap(*view, bounds);
+    };
+
+    // explosions never move, nothing to interpolate
+    commands.setLayer(RenderLayer::EXPLOSIONS);
+    explosions.render(commands, view);
+    for (const PlayerEntities& entities: players) {
+        commands.setLayer(RenderLayer::ROCKETS);
+        for (const Rocket *rocket: entities.rockets) {
+            if (rocket != nullptr && inView(rocket->renderBounds()))
+                rocket->render(commands, alpha);
+        }
+        commands.setLayer(RenderLayer::RECOIL_WAVES);
+        if (inView(entities.recoilWave.renderBounds()))
+            entities.recoilWave.render(commands, alpha);
+        commands.setLayer(RenderLayer::PLAYERS);
+        if (inView(entities.player.renderBounds()))
+            entities.player.render(commands, alpha);
+    }
+
+    // walls never move, nothing to interpolate either
+    Rectangle pixelView = {};
+    if (view != nullptr) {
+        Vector2 lower = box2dToRaylib(view->lowerBound);
+        Vector2 upper = box2dToRaylib(view->upperBound);
+        pixelView = {lower.x, lower.y, upper.x - lower.x, upper.y - lower.y};
+    }
+    commands.setLayer(RenderLayer::WALLS);
+    wallLayer.render(commands, walls, view != nullptr ? &pixelView : nullptr);
+    if (levelStreamer)
+        levelStreamer->render(commands, view != nullptr ? &pixelView : nullptr);
+}
+
+void Simulation::rebuildWorld() {
+    RJ_PROFILE_SCOPE("rebuildWorld");
+    blueprints.clear();
+    forEachEntity([this](Entity& entity) {
+        blueprints.push_back(entity.saveBlueprint());
+    });
+
+    // a world that only had bodies destroyed would still hand out proxy
+    // ids, which decide the order contacts are created and solved in,
+    // depending on its history
+    b2Vec2 gravity = world.GetGravity();
+    std::destroy_at(&world);
+    std::construct_at(&world, gravity);
+    world.SetContactListener(&contactListener);
+
+    size_t next = 0;
+    forEachEntity([this, &next](Entity& entity) {
+        entity.rebuildBody(blueprints[next++]);
+    });
+    // forces applied after the last world step went with the old bodies
+    for (PlayerEntities& entities: players)
+        feelNearbyExplosions(entities.player);
+    // contacts of the new bodies can only begin
+    nearbyExplosionsRestored = options.explosionDetection == ExplosionDetection::SENSOR_BODIES;
+}
+
+uint64_t Simulation::tick() const {
+    return currentTick;
+}
+
+size_t Simulation::playerCount() const {
+    return players.size();
+}
+
+const SimulationOptions& Simulation::getOptions() const {
+    return options;
+}
+
+const Player& Simulation::getPlayer(size_t index) const {
+    return players.at(index).player;
+}
+
+const ExplosionSystem& Simulation::getExplosions() const {
+    return explosions;
+}
+
+void Simulation::saveState(std::vector<uint8_t>& out) const {
+    ByteWriter writer(out);
+    writer.put(currentTick);
+    writer.put(static_cast<uint32_t>(players.size()));
+    for (const PlayerEntities& entities: players) {
+        writer.put(entities.rocketIndex);
+        writer.put(entities.player.saveState());
+        writer.put(entities.recoilWave.saveState());
+
+        uint8_t rocketMask = 0;
+        for (int i = 0; i < Player::maxRockets; i++) {
+            if (entities.rockets.at(i) != nullptr)
+                rocketMask |= 1 << i;
+        }
+        writer.put(rocketMask);
+        for (const Rocket *rocket: entities.rockets) {
+            if (rocket != nullptr)
+                writer.put(rocket->saveState());
+        }
+    }
+
+    explosions.saveState(writer);
+}
+
+void Simulation::loadState(const uint8_t *data, size_t size) {
+    ByteReader reader(data, size);
+    currentTick = reader.get<uint64_t>();
+    if (reader.get<uint32_t>() != players.size())
+        throw std::invalid_argument("state was saved with a different amount of players");
+
+    for (PlayerEntities& entities: players) {
+        entities.rocketIndex = reader.get<int>();
+        entities.player.loadState(reader.get<Player::State>());
+        entities.recoilWave.loadState(reader.get<RecoilWave::State>());
+
+        auto rocketMask = reader.get<uint8_t>();
+        for (int i = 0; i < Player::maxRockets; i++) {
+            Rocket *&rocketRef = entities.rockets.at(i);
+            rocketPool.destroy(rocketRef);
+            rocketRef = nullptr;
+            if (rocketMask & (1 << i)) {
+                auto state = reader.get<Rocket::State>();
+                rocketRef = rocketPool.create(world, state.body.position, state.direction);
+                rocketRef->loadState(state);
+            }
+        }
+    }
+
+    explosions.loadState(reader);
+    // refilled by BeginContact once the new explosion bodies get simulated
+    for (PlayerEntities& entities: players)
+        entities.player.getNearbyExplosions().clear();
+}
+
+uint64_t Snapshot::checksum() const {
+    return fnv1a(bytes.data(), bytes.size());
+}
+
+size_t Simulation::playerSnapshotSize() const {
+    return sizeof(PlayerSnapshot) + explosions.capacity() * sizeof(uint32_t);
+}
+
+size_t Simulation::snapshotSize() const {
+    return sizeof(SnapshotHeader) + players.size() * playerSnapshotSize() + explosions.snapshotSize();
+}
+
+void Simulation::saveSnapshot(Snapshot& snapshot) const {
+    snapshot.bytes.resize(snapshotSize());
+    uint8_t *out = snapshot.bytes.data();
+
+    SnapshotHeader header = {
+        .tick = currentTick,
+        .playerCount = static_cast<uint32_t>(players.size()),
+        .explosionCapacity = static_cast<uint32_t>(explosions.capacity()),
+    };
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+
+    for (const PlayerEntities& entities: players) {
+        // value initialized, so empty rocket slots are zeroes
+        PlayerSnapshot record{};
+        record.player = entities.player.saveState();
+        record.recoilWave = entities.recoilWave.saveState();
+        record.rocketIndex = entities.rocketIndex;
+        record.rocketMask = 0;
+        for (int i = 0; i < Player::maxRockets; i++) {
+            if (entities.rockets[i] != nullptr) {
+                record.rockets[i] = entities.rockets[i]->saveState();
+                record.rocketMask |= 1u << i;
+            }
+        }
+        const SparseSet& nearby = entities.player.getNearbyExplosions();
+        record.nearbyExplosionCount = static_cast<uint32_t>(nearby.size());
+        std::memcpy(out, &record, sizeof(record));
+
+        uint8_t *slots = out + sizeof(record);
+        size_t usedBytes = nearby.size() * sizeof(uint32_t);
+        std::memcpy(slots, nearby.begin(), usedBytes);
+        // the buffer is reused, leftovers from a previous snapshot would
+        // make equal states compare unequal
+        std::memset(slots + usedBytes, 0, explosions.capacity() * sizeof(uint32_t) - usedBytes);
+        out += playerSnapshotSize();
+    }
+
+    explosions.saveSnapshot(out);
+}
+
+void Simulation::loadSnapshot(const Snapshot& snapshot) {
+    const uint8_t *in = snapshot.bytes.data();
+    SnapshotHeader header;
+    if (snapshot.size() != snapshotSize())
+        throw std::invalid_argument("snapshot was saved by a different simulation");
+    std::memcpy(&header, in, sizeof(header));
+    if (header.playerCount != players.size() || header.explosionCapacity != explosions.capacity())
+        throw std::invalid_argument("snapshot was saved by a different simulation");
+    in += sizeof(header);
+    currentTick = header.tick;
+
+    // first, destroying the old explosion bodies ends their contacts,
+    // which would remove slots from the restored nearby explosions
+    explosions.loadSnapshot(in + players.size() * playerSnapshotSize());
+    nearbyExplosionsRestored = options.explosionDetection == ExplosionDetection::SENSOR_BODIES;
+
+    for (PlayerEntities& entities: players) {
+        PlayerSnapshot record;
+        std::memcpy(&record, in, sizeof(record));
+        entities.player.loadState(record.player);
+        entities.recoilWave.loadState(record.recoilWave);
+        entities.rocketIndex = record.rocketIndex;
+
+        for (int i = 0; i < Player::maxRockets; i++) {
+            Rocket *&rocketRef = entities.rockets[i];
+            const Rocket::State& state = record.rockets[i];
+            // a rocket's direction is fixed, a different one takes a new rocket
+            bool keep = rocketRef != nullptr && (record.rocketMask & (1u << i))
+                && rocketRef->getDirection() == state.direction;
+            if (rocketRef != nullptr && !keep) {
+                rocketPool.destroy(rocketRef);
+                rocketRef = nullptr;
+            }
+            if (record.rocketMask & (1u << i)) {
+                if (rocketRef == nullptr)
+                    rocketRef = rocketPool.create(world, state.body.position, state.direction);
+                rocketRef->loadState(state);
+            }
+        }
+
+        SparseSet& nearby = entities.player.getNearbyExplosions();
+        nearby.clear();
+        const uint8_t *slots = in + sizeof(record);
+        for (uint32_t i = 0; i < record.nearbyExplosionCount; i++) {
+            uint32_t slot;
+            std::memcpy(&slot, slots + i * sizeof(slot), sizeof(slot));
+            nearby.insert(slot);
+        }
+        in += playerSnapshotSize();
+    }
+}
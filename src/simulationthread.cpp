@@ -0,0 +1,101 @@
+#include "simulationthread.hpp"
+
+#include <algorithm>
+
+#include "world.hpp"
+#include "fixedtimestep.hpp"
+#include "profiler.hpp"
+
+float RenderFrame::alphaAt(std::chrono::steady_clock::time_point time) const {
+    std::chrono::duration<float> sinceStep = time - steppedAt;
+    return std::clamp(sinceStep.count() / SIMULATION_STEP_INTERVAL, 0.0f, 1.0f);
+}
+
+SimulationThread::SimulationThread(Simulation& simulation, ReplayWriter *recorder):
+    simulation(simulation),
+    recorder(recorder)
+{
+    // so the first frames drawn show something
+    publishFrame();
+    thread = std::thread(&SimulationThread::run, this);
+}
+
+SimulationThread::~SimulationThread() {
+    stopping.store(true, std::memory_order_relaxed);
+    thread.join();
+}
+
+void SimulationThread::queueInput(const TickInput& input) {
+    std::lock_guard lock(inputMutex);
+    queuedInputs.push_back(input);
+}
+
+void SimulationThread::setView(const b2AABB& view) {
+    std::lock_guard lock(inputMutex);
+    this->view = view;
+}
+
+const RenderFrame& SimulationThread::latestFrame() {
+    frames.update();
+    return frames.readBuffer();
+}
+
+void SimulationThread::run() {
+    FixedTimestep timestep;
+    auto lastTime = std::chrono::steady_clock::now();
+    while (!stopping.load(std::memory_order_relaxed)) {
+        auto now = std::chrono::steady_clock::now();
+        int steps = timestep.advance(std::chrono::duration<float>(now - lastTime).count());
+        lastTime = now;
+
+        for (int i = 0; i < steps; i++) {
+            applyQueuedInputs();
+            simulation.step();
+            if (recorder) recorder->afterStep(simulation);
+        }
+        if (steps > 0)
+            publishFrame();
+
+        // until the next step is due
+        float untilNextStep = (1.0f - timestep.alpha()) * SIMULATION_STEP_INTERVAL;
+        std::this_thread::sleep_for(std::chrono::duration<float>(untilNextStep));
+    }
+}
+
+void SimulationThread::applyQueuedInputs() {
+    {
+        std::lock_guard lock(inputMutex);
+        std::swap(queuedInputs, takenInputs);
+    }
+    for (const TickInput& input: takenInputs) {
+        simulation.applyInput(0, input);
+        if (recorder) recorder->recordInput(simulation, 0, input);
+    }
+    takenInputs.clear();
+}
+
+void SimulationThread::publishFrame() {
+    RJ_PROFILE_SCOPE("publishFrame");
+    std::optional<b2AABB> frameView;
+    {
+        std::lock_guard lock(inputMutex);
+        frameView = view;
+    }
+    const b2AABB *culling = frameView ? &*frameView : nullptr;
+
+    RenderFrame& frame = frames.writeBuffer();
+    frame.previous.clear();
+    simulation.render(frame.previous, 0.0f, culling);
+    frame.previous.sort();
+    frame.current.clear();
+    simulation.render(frame.current, 1.0f, culling);
+    frame.current.sort();
+
+    frame.tick = simulation.tick();
+    frame.steppedAt = std::chrono::steady_clock::now();
+    const Player& player = simulation.getPlayer();
+    frame.rocketAmmo = player.getRocketAmmo();
+    frame.rocketReload = player.getRocketReload();
+    frame.recoilReload = player.getRecoilReload();
+    frames.publish();
+}
@@ -0,0 +1,50 @@
+#include "sparseset.hpp"
+
+SparseSet::SparseSet(size_t capacity): sparse(capacity, 0) {
+    dense.reserve(capacity);
+}
+
+bool SparseSet::insert(uint32_t value) {
+    if (contains(value)) return false;
+    sparse.at(value) = dense.size();
+    dense.push_back(value);
+    return true;
+}
+
+bool SparseSet::erase(uint32_t value) {
+    if (!contains(value)) return false;
+    // move the last member into the hole
+    uint32_t position = sparse[value];
+    uint32_t last = dense.back();
+    dense[position] = last;
+    sparse[last] = position;
+    dense.pop_back();
+    return true;
+}
+
+bool SparseSet::contains(uint32_t value) const {
+    // sparse may hold stale positions, only trust them if dense agrees
+    return value < sparse.size()
+        && sparse[value] < dense.size()
+        && dense[sparse[value]] == value;
+}
+
+void SparseSet::clear() {
+    dense.clear();
+}
+
+size_t SparseSet::size() const {
+    return dense.size();
+}
+
+size_t SparseSet::capacity() const {
+    return sparse.size();
+}
+
+const uint32_t *SparseSet::begin() const {
+    return dense.data();
+}
+
+const uint32_t *SparseSet::end() const {
+    return dense.data() + dense.size();
+}
@@ -1,23 +1,61 @@
 #include "timer.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#include "timerwheel.hpp"
+
 void nop() {}
 
 Timer::Timer(float length): Timer(length, &nop) {}
 
-Timer::Timer(float length, Timer::Action autoAction):
+Timer::Timer(float length, Timer::Action autoAction, TimerWheel *timerWheel):
     len(length),
-    action(autoAction)
+    action(autoAction),
+    wheel(timerWheel)
 {
+    if (wheel != nullptr)
+        lengthTicks = wheel->ticksFor(len);
     reset();
 }
 
+Timer::~Timer() {
+    TimerWheel::unlink(*this);
+}
+
+uint64_t Timer::elapsedTicks() const {
+    if (!running)
+        return pausedTicks;
+    return std::min<uint64_t>(wheel->now() - startTick, lengthTicks);
+}
+
+float Timer::currentElapsed() const {
+    if (wheel == nullptr)
+        return elapsed;
+    uint64_t ticks = elapsedTicks();
+    if (ticks >= lengthTicks)
+        return len;
+    return std::min(static_cast<float>(ticks) * wheel->tickInterval(), len);
+}
+
+void Timer::schedule() {
+    TimerWheel::unlink(*this);
+    if (running && !didAction)
+        wheel->schedule(*this, startTick + lengthTicks);
+}
+
 bool Timer::done() {
-    return elapsed >= len;
+    return currentElapsed() >= len;
 }
 
 void Timer::reset() {
     didAction = false;
     elapsed = 0;
+    if (wheel != nullptr) {
+        startTick = wheel->now();
+        pausedTicks = 0;
+        schedule();
+    }
 }
 
 void Timer::performAction() {
@@ -37,15 +75,36 @@ bool Timer::triggerActionAgainIfDone() {
 void Timer::setToComplete() {
     if (!done()) {
         elapsed = len;
+        if (wheel != nullptr) {
+            startTick = wheel->now() - lengthTicks;
+            pausedTicks = lengthTicks;
+            TimerWheel::unlink(*this);
+        }
         performAction();
     }
 }
 
+void Timer::setRunning(bool run) {
+    if (run == running) return;
+    if (wheel != nullptr) {
+        if (run) {
+            startTick = wheel->now() - pausedTicks;
+        } else {
+            pausedTicks = elapsedTicks();
+        }
+    }
+    running = run;
+    if (wheel != nullptr)
+        schedule();
+}
+
 float Timer::length() const {
     return len;
 }
 
 void Timer::update(float deltaTime) {
+    if (!running || wheel != nullptr)
+        return;
     if (elapsed < len)
         elapsed += deltaTime;
     if (elapsed > len)
@@ -56,13 +115,32 @@ void Timer::update(float deltaTime) {
 }
 
 float Timer::progress() const {
-    return elapsed / len;
+    return currentElapsed() / len;
 }
 
 float Timer::timeLeft() const {
-    return len - elapsed;
+    return len - currentElapsed();
 }
 
 float Timer::timeElapsed() const {
-    return elapsed;
+    return currentElapsed();
+}
+
+Timer::State Timer::saveState() const {
+    return { .elapsed = currentElapsed(), .didAction = didAction };
+}
+
+void Timer::loadState(const Timer::State& state) {
+    elapsed = state.elapsed;
+    didAction = state.didAction;
+    if (wheel != nullptr) {
+        uint64_t ticks = lengthTicks;
+        if (elapsed < len) {
+            float exactTicks = std::round(elapsed / wheel->tickInterval());
+            ticks = std::min<uint64_t>(static_cast<uint64_t>(exactTicks), lengthTicks);
+        }
+        startTick = wheel->now() - ticks;
+        pausedTicks = ticks;
+        schedule();
+    }
 }
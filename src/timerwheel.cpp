@@ -0,0 +1,84 @@
+#include "timerwheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "timer.hpp"
+
+TimerWheel::TimerWheel(float tickInterval, size_t slotCount):
+    interval(tickInterval),
+    slots(std::bit_ceil(std::max<size_t>(slotCount, 1)), nullptr)
+{}
+
+TimerWheel::~TimerWheel() {
+    // timers outliving the wheel are left unscheduled rather than dangling
+    for (Timer *&head: slots) {
+        while (head != nullptr) unlink(*head);
+    }
+    while (due != nullptr) unlink(*due);
+}
+
+void TimerWheel::link(Timer **head, Timer& timer) {
+    timer.wheelNext = *head;
+    if (*head != nullptr)
+        (*head)->wheelPrevNext = &timer.wheelNext;
+    timer.wheelPrevNext = head;
+    *head = &timer;
+}
+
+void TimerWheel::unlink(Timer& timer) {
+    if (timer.wheelPrevNext == nullptr) return;
+    *timer.wheelPrevNext = timer.wheelNext;
+    if (timer.wheelNext != nullptr)
+        timer.wheelNext->wheelPrevNext = timer.wheelPrevNext;
+    timer.wheelNext = nullptr;
+    timer.wheelPrevNext = nullptr;
+}
+
+void TimerWheel::schedule(Timer& timer, uint64_t deadline) {
+    unlink(timer);
+    // never in the past, the current tick's bucket has already been visited
+    timer.deadline = std::max(deadline, currentTick + 1);
+    link(&slots[timer.deadline & (slots.size() - 1)], timer);
+}
+
+void TimerWheel::advance() {
+    currentTick++;
+    Timer *timer = slots[currentTick & (slots.size() - 1)];
+    while (timer != nullptr) {
+        Timer *next = timer->wheelNext;
+        if (timer->deadline == currentTick) {
+            unlink(*timer);
+            link(&due, *timer);
+        }
+        timer = next;
+    }
+
+    // actions may reset, pause or reschedule any timer, including the due ones
+    while (due != nullptr) {
+        Timer& expired = *due;
+        unlink(expired);
+        if (!expired.didAction)
+            expired.performAction();
+    }
+}
+
+uint64_t TimerWheel::now() const {
+    return currentTick;
+}
+
+float TimerWheel::tickInterval() const {
+    return interval;
+}
+
+uint32_t TimerWheel::ticksFor(float duration) const {
+    // accumulated the same way Timer::update does, so a timer expires on
+    // the same step whether it's on a wheel or not
+    uint32_t ticks = 0;
+    float elapsed = 0.0f;
+    do {
+        elapsed += interval;
+        ticks++;
+    } while (elapsed < duration);
+    return ticks;
+}
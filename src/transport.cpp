@@ -0,0 +1,46 @@
+#include "transport.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+LoopbackLink::LoopbackLink(LoopbackOptions options):
+    options(options),
+    random(options.seed),
+    first(*this),
+    second(*this)
+{
+    first.peer = &second;
+    second.peer = &first;
+}
+
+Transport& LoopbackLink::endpoint(size_t index) {
+    if (index > 1)
+        throw std::out_of_range("a loopback link only has two endpoints");
+    return index == 0 ? static_cast<Transport&>(first) : second;
+}
+
+void LoopbackLink::advance(float seconds) {
+    now += seconds;
+}
+
+void LoopbackLink::Endpoint::send(const std::vector<uint8_t>& packet) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    if (unit(link.random) < link.options.loss)
+        return;
+    double delay = link.options.latency + link.options.jitter * unit(link.random);
+    peer->incoming.push_back(InFlight{link.now + delay, link.nextSequence++, packet});
+}
+
+bool LoopbackLink::Endpoint::receive(std::vector<uint8_t>& packet) {
+    auto earliest = std::min_element(incoming.begin(), incoming.end(), [](const InFlight& a, const InFlight& b) {
+        return std::pair(a.deliverAt, a.sequence) < std::pair(b.deliverAt, b.sequence);
+    });
+    if (earliest == incoming.end() || earliest->deliverAt > link.now)
+        return false;
+    packet.swap(earliest->bytes);
+    // order within incoming doesn't matter
+    std::swap(*earliest, incoming.back());
+    incoming.pop_back();
+    return true;
+}
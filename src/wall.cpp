@@ -13,15 +13,15 @@ b2Body *constructWallBody(b2World& world, b2Vec2 position) {
     return world.CreateBody(&bodyDef);
 }
 
-b2Shape *constructWallShape(b2Vec2 dimensions) {
-    auto box = new b2PolygonShape();
+b2PolygonShape constructWallShape(b2Vec2 dimensions) {
+    b2PolygonShape box;
     b2Vec2 vertices[4] = {
         {0, 0},
         {0, dimensions.y},
         {dimensions.x, dimensions.y},
         {dimensions.x, 0}
     };
-    box->Set(vertices, 4);
+    box.Set(vertices, 4);
     return box;
 }
 
@@ -36,7 +36,11 @@ Wall::Wall(b2World& world, b2Vec2 position, b2Vec2 dimensions)
     ),
     pixelDimensions(box2dToRaylib(dimensions)) {}
 
-void Wall::render() const {
+Rectangle Wall::pixelBounds() const {
     Vector2 position = raylibPosition();
-    DrawRectangleLines(position.x, position.y, pixelDimensions.x, pixelDimensions.y, WHITE);
+    return {position.x, position.y, pixelDimensions.x, pixelDimensions.y};
+}
+
+void Wall::render(RenderCommandBuffer& commands, float alpha) const {
+    commands.rectangleLines(pixelBounds(), WHITE);
 }
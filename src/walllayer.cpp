@@ -0,0 +1,21 @@
+#include "walllayer.hpp"
+
+std::atomic<bool> WallLayer::cachingEnabled = true;
+
+void WallLayer::invalidate() {
+    outlines.reset();
+}
+
+void WallLayer::setCachingEnabled(bool enabled) {
+    cachingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool WallLayer::isCachingEnabled() {
+    return cachingEnabled.load(std::memory_order_relaxed);
+}
+
+bool WallLayer::fitsTexture(Rectangle bounds) {
+    return bounds.width > 0
+        && std::ceil(bounds.width * textureScale) <= maxTextureSize
+        && std::ceil(bounds.height * textureScale) <= maxTextureSize;
+}
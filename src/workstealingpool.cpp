@@ -0,0 +1,129 @@
+#include "workstealingpool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+size_t WorkStealingPool::defaultThreadCount() {
+    // 0 when unknown
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+WorkStealingPool::WorkStealingPool(size_t threadCount):
+    ranges(new Range[std::max<size_t>(threadCount, 1)]),
+    rangeCount(std::max<size_t>(threadCount, 1))
+{
+    // range 0 belongs to whoever calls parallelFor
+    threads.reserve(rangeCount - 1);
+    for (size_t i = 1; i < rangeCount; i++)
+        threads.emplace_back(&WorkStealingPool::threadLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread: threads)
+        thread.join();
+}
+
+size_t WorkStealingPool::threadCount() const {
+    return rangeCount;
+}
+
+void WorkStealingPool::parallelFor(size_t count, Task loopTask) {
+    if (count == 0) return;
+
+    // no thread can be running the previous task anymore, its last
+    // index finished before the previous call returned
+    task = loopTask;
+    remaining.store(count, std::memory_order_relaxed);
+    for (size_t i = 0; i < rangeCount; i++) {
+        std::lock_guard lock(ranges[i].mutex);
+        ranges[i].begin = count * i / rangeCount;
+        ranges[i].end = count * (i + 1) / rangeCount;
+    }
+    {
+        std::lock_guard lock(stateMutex);
+        generation++;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    std::unique_lock lock(stateMutex);
+    finished.wait(lock, [this](){ return remaining.load(std::memory_order_acquire) == 0; });
+    if (firstException) {
+        std::exception_ptr exception = std::exchange(firstException, nullptr);
+        std::rethrow_exception(exception);
+    }
+}
+
+void WorkStealingPool::threadLoop(size_t self) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock lock(stateMutex);
+            wake.wait(lock, [&](){ return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+        work(self);
+    }
+}
+
+void WorkStealingPool::work(size_t self) {
+    size_t index;
+    while (claim(self, index)) {
+        try {
+            task(index);
+        } catch (...) {
+            std::lock_guard lock(stateMutex);
+            if (!firstException)
+                firstException = std::current_exception();
+        }
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // locked so the caller can't miss it between checking and waiting
+            std::lock_guard lock(stateMutex);
+            finished.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::claim(size_t self, size_t& index) {
+    {
+        Range& own = ranges[self];
+        std::lock_guard lock(own.mutex);
+        if (own.begin < own.end) {
+            index = own.begin++;
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < rangeCount; offset++) {
+        if (steal(self, (self + offset) % rangeCount, index))
+            return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::steal(size_t self, size_t victim, size_t& index) {
+    size_t begin, end;
+    {
+        Range& other = ranges[victim];
+        std::lock_guard lock(other.mutex);
+        if (other.begin >= other.end)
+            return false;
+        // the back half, the bigger one when odd so a last single index can be stolen too
+        size_t middle = other.begin + (other.end - other.begin) / 2;
+        begin = middle;
+        end = other.end;
+        other.end = middle;
+    }
+    index = begin;
+    Range& own = ranges[self];
+    std::lock_guard lock(own.mutex);
+    own.begin = begin + 1;
+    own.end = end;
+    return true;
+}
@@ -7,3 +7,21 @@ Vector2 box2dToRaylib(b2Vec2 position) {
 b2Vec2 raylibToBox2d(Vector2 position) {
     return { position.x * METERS_PER_PIXEL, position.y * METERS_PER_PIXEL };
 }
+
+void metersToPixels(std::span<float> values) {
+    for (float& value: values)
+        value *= PIXELS_PER_METER;
+}
+
+b2AABB cameraView(const Camera2D& camera, Vector2 screenSize) {
+    auto screenToWorld = [&camera](float x, float y) {
+        return raylibToBox2d({
+            (x - camera.offset.x) / camera.zoom + camera.target.x,
+            (y - camera.offset.y) / camera.zoom + camera.target.y
+        });
+    };
+    b2AABB view;
+    view.lowerBound = screenToWorld(0, 0);
+    view.upperBound = screenToWorld(screenSize.x, screenSize.y);
+    return view;
+}
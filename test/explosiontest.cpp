@@ -0,0 +1,85 @@
+#include <algorithm>
+
+#include "simulation.hpp"
+#include "test.hpp"
+
+// fires as often as the rockets stay out of each other's explosions,
+// either into the air so every rocket runs out of time and explodes
+// twice, or into the ground right away
+static size_t peakExplosions(b2Vec2 target, SimulationOptions options) {
+    Simulation simulation(1, options);
+    size_t peak = 0;
+    for (int i = 0; i < 1200; i++) {
+        TickInput input;
+        // alternating sides, so rockets fired one after the other spread apart
+        b2Vec2 side = {i % 16 < 8 ? -30.0f : 30.0f, 0};
+        input.target = simulation.getPlayer().box2dPosition() + target + side;
+        input.leftPressed = i % 8 == 0;
+        simulation.applyInput(0, input);
+        simulation.step();
+        peak = std::max(peak, simulation.getExplosions().size());
+    }
+    CHECK_EQUAL(simulation.getExplosions().droppedCount(), 0u);
+    return peak;
+}
+
+TEST(explosionsFitTheirCapacity) {
+    for (SimulationOptions options: {SimulationOptions{}, SimulationOptions{.explosionDetection = ExplosionDetection::QUERIES}}) {
+        size_t upwards = peakExplosions({0, -100}, options);
+        // more than one per rocket
+        CHECK(upwards > static_cast<size_t>(Player::maxRockets));
+        CHECK(upwards <= Simulation::maxExplosionsPerPlayer);
+        size_t downwards = peakExplosions({0, 100}, options);
+        CHECK(downwards > 0);
+        CHECK(downwards <= Simulation::maxExplosionsPerPlayer);
+    }
+}
+
+TEST(explosionsCountWhatDoesntFit) {
+    b2World world(b2Vec2{0, 0});
+    ExplosionSystem explosions(world, 8, ExplosionDetection::QUERIES);
+    REQUIRE(explosions.capacity() == 8u);
+    for (int i = 0; i < 8; i++)
+        CHECK(explosions.spawn({0, 0}));
+    CHECK(!explosions.spawn({0, 0}));
+    CHECK_EQUAL(explosions.size(), 8u);
+    CHECK_EQUAL(explosions.droppedCount(), 1u);
+
+    // room is made once the oldest ones are over
+    explosions.update(ExplosionSystem::lifetime);
+    CHECK_EQUAL(explosions.size(), 0u);
+    CHECK(explosions.spawn({0, 0}));
+    CHECK_EQUAL(explosions.droppedCount(), 1u);
+}
+
+// a rocket fired into the ground right under the player
+static void checkPlayerFeelsExplosion(SimulationOptions options) {
+    Simulation simulation(1, options);
+    // let the player land first
+    for (int i = 0; i < 120; i++)
+        simulation.step();
+
+    TickInput input;
+    input.target = simulation.getPlayer().box2dPosition() + b2Vec2{0, 100};
+    input.leftPressed = true;
+    simulation.applyInput(0, input);
+    bool reached = false;
+    for (int i = 0; i < 30; i++) {
+        simulation.step();
+        reached = reached || simulation.getPlayer().getNearbyExplosions().size() > 0;
+    }
+    CHECK(reached);
+
+    for (int i = 0; i < 120; i++)
+        simulation.step();
+    CHECK_EQUAL(simulation.getExplosions().size(), 0u);
+    CHECK_EQUAL(simulation.getPlayer().getNearbyExplosions().size(), 0u);
+}
+
+TEST(explosionsReachPlayersWithSensors) {
+    checkPlayerFeelsExplosion({.explosionDetection = ExplosionDetection::SENSOR_BODIES});
+}
+
+TEST(explosionsReachPlayersWithQueries) {
+    checkPlayerFeelsExplosion({.explosionDetection = ExplosionDetection::QUERIES});
+}
@@ -0,0 +1,23 @@
+#include "fixedtimestep.hpp"
+#include "test.hpp"
+
+// powers of two, so the accumulator adds up exactly
+constexpr float interval = 0.25f;
+
+TEST(fixedTimestepCarriesLeftoverTime) {
+    FixedTimestep timestep(interval, 4);
+    CHECK_EQUAL(timestep.advance(0.125f), 0);
+    CHECK_EQUAL(timestep.alpha(), 0.5f);
+    CHECK_EQUAL(timestep.advance(0.25f), 1);
+    CHECK_EQUAL(timestep.alpha(), 0.5f);
+    CHECK_EQUAL(timestep.advance(0.125f), 1);
+    CHECK_EQUAL(timestep.alpha(), 0.0f);
+}
+
+TEST(fixedTimestepDropsTimeBeyondTheCap) {
+    FixedTimestep timestep(interval, 2);
+    CHECK_EQUAL(timestep.advance(2.0f + 0.125f), 2);
+    // only the fraction of a step is kept, not the six steps it fell behind
+    CHECK_EQUAL(timestep.alpha(), 0.5f);
+    CHECK_EQUAL(timestep.advance(0.125f), 1);
+}
@@ -0,0 +1,9 @@
+// json11 once more, renamed, and built without its SSE2 and AVX2 block scans so that it reads
+// a char at a time like it did before them, for jsonscantest.cpp to check the scans against
+#undef __SSE2__
+#undef __AVX2__
+#define json11 json11_scalar
+// the parser's internals are in an anonymous namespace, which GCC only expects from a main file
+#pragma GCC diagnostic ignored "-Wsubobject-linkage"
+#include "../src/json11.cpp"
+#include "jsonreference.cpp"
@@ -0,0 +1,104 @@
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "json11.hpp"
+#include "test.hpp"
+
+using json11::Json;
+using json11::JsonDocument;
+using json11::JsonView;
+
+constexpr std::string_view level = R"({
+    "name": "tab\there \u00e9",
+    "gravity": -9.8,
+    "walls": [
+        {"position": [-10, 10], "size": [20, 5], "solid": true},
+        {"position": [4, -2.5], "size": [1, 0.5], "color": null}
+    ],
+    "empty": {"list": [], "object": {}}
+})";
+
+TEST(jsonDocumentMatchesTree) {
+    std::string err;
+    JsonDocument document = JsonDocument::parse(level, err);
+    CHECK_EQUAL(err, std::string());
+    CHECK(document.arena_size() > 0u);
+    Json tree = Json::parse(level, err);
+    CHECK(document.root().to_json() == tree);
+
+    JsonView root = document.root();
+    CHECK(root.is_object());
+    CHECK_EQUAL(root["name"].string_value(), std::string_view("tab\there \xc3\xa9"));
+    CHECK_EQUAL(root["gravity"].number_value(), -9.8);
+    REQUIRE(root["walls"].size() == 2u);
+    CHECK_EQUAL(root["walls"][0]["size"][1].int_value(), 5);
+    CHECK(root["walls"][0]["solid"].bool_value());
+    CHECK(root["walls"][1]["color"].is_null());
+    CHECK(root["empty"]["list"].is_array() && root["empty"]["list"].size() == 0u);
+    CHECK(root["empty"]["object"].is_object());
+}
+
+TEST(jsonDocumentReturnsEmptyViewsForWhatIsMissing) {
+    std::string err;
+    JsonDocument document = JsonDocument::parse(level, err);
+    JsonView root = document.root();
+    CHECK(root["missing"].is_null());
+    CHECK(root["walls"][2].is_null());
+    CHECK(root["gravity"]["walls"].is_null());
+    CHECK(root[0].is_null());
+    CHECK_EQUAL(root["walls"].key(0), std::string_view());
+    CHECK(JsonDocument().root().is_null());
+}
+
+TEST(jsonDocumentViewsSurviveMoves) {
+    std::string err;
+    JsonDocument document = JsonDocument::parse(level, err);
+    JsonView name = document.root()["name"];
+    JsonDocument moved = std::move(document);
+    CHECK_EQUAL(name.string_value(), std::string_view("tab\there \xc3\xa9"));
+    CHECK_EQUAL(moved.root()["walls"][1]["position"][1].number_value(), -2.5);
+}
+
+TEST(jsonDocumentFailsLikeTree) {
+    for (std::string_view in: {"", "[1, 2", "{\"a\" 1}", "[1] 2", "\"\\x\"", "[01]", "// c\n1"}) {
+        std::string documentErr, treeErr;
+        JsonDocument document = JsonDocument::parse(in, documentErr);
+        Json::parse(in, treeErr);
+        CHECK(!documentErr.empty());
+        CHECK_EQUAL(documentErr, treeErr);
+        CHECK(document.root().is_null());
+    }
+    std::string err;
+    JsonDocument commented = JsonDocument::parse("// c\n[1 /* 2 */]", err, json11::JsonParse::COMMENTS);
+    CHECK_EQUAL(err, std::string());
+    CHECK_EQUAL(commented.root().size(), 1u);
+}
+
+TEST(jsonParsesOnlyTheView) {
+    // what follows each view would change its meaning if it were read
+    struct Case {
+        std::string_view buffer;
+        size_t length;
+        json11::JsonParse strategy;
+    };
+    for (Case c: {Case{"123", 2, json11::JsonParse::STANDARD},
+                  Case{"1.5e3", 3, json11::JsonParse::STANDARD},
+                  Case{"-0", 1, json11::JsonParse::STANDARD},
+                  Case{"true", 3, json11::JsonParse::STANDARD},
+                  Case{"\"ab\"", 3, json11::JsonParse::STANDARD},
+                  Case{"[1] x", 3, json11::JsonParse::STANDARD},
+                  Case{"1 /* c */", 4, json11::JsonParse::COMMENTS},
+                  Case{"1 // c\n2", 6, json11::JsonParse::COMMENTS}}) {
+        std::string_view in = c.buffer.substr(0, c.length);
+        std::string copy(in);
+        std::string viewErr, copyErr;
+        Json fromView = Json::parse(in, viewErr, c.strategy);
+        Json fromCopy = Json::parse(copy, copyErr, c.strategy);
+        CHECK(fromView == fromCopy);
+        CHECK_EQUAL(viewErr, copyErr);
+        JsonDocument document = JsonDocument::parse(in, viewErr, c.strategy);
+        CHECK(document.root().to_json() == fromCopy);
+        CHECK_EQUAL(viewErr, copyErr);
+    }
+}
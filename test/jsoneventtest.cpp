@@ -0,0 +1,112 @@
+#include <string>
+#include <string_view>
+
+#include "json11.hpp"
+#include "test.hpp"
+
+using json11::Json;
+using json11::JsonEventParser;
+
+// writes down every event, with values as Json::dump writes them
+class EventLog final : public json11::JsonHandler {
+public:
+    std::string events;
+
+    void null_value() override { events += "null "; }
+    void bool_value(bool value) override { events += value ? "true " : "false "; }
+    void number_value(double value) override { write(Json(value)); }
+    void string_value(std::string_view value) override { write(Json(std::string(value))); }
+    void start_array() override { events += "[ "; }
+    void end_array() override { events += "] "; }
+    void start_object() override { events += "{ "; }
+    void key(std::string_view key) override {
+        Json(std::string(key)).dump(events);
+        events += ": ";
+    }
+    void end_object() override { events += "} "; }
+
+private:
+    void write(const Json& value) {
+        value.dump(events);
+        events += ' ';
+    }
+};
+
+constexpr std::string_view walls = R"({"walls": [{"position": [-10, 1.5e1], "size": [20, 5]},
+    {"name": "a\"b\u00e9", "solid": true, "color": null}], "empty": [{}, []]})";
+
+constexpr std::string_view wallEvents = R"({ "walls": [ { "position": [ -10 15 ] "size": [ 20 5 ] } )"
+    R"({ "name": "a\"bé" "solid": true "color": null } ] "empty": [ { } [ ] ] } )";
+
+TEST(jsonEventsArriveInOrder) {
+    EventLog log;
+    std::string err;
+    CHECK(JsonEventParser::parse(walls, log, err));
+    CHECK_EQUAL(err, std::string());
+    CHECK_EQUAL(log.events, std::string(wallEvents));
+}
+
+TEST(jsonEventsDontDependOnChunks) {
+    // split in two at every position, then a byte at a time
+    for (size_t split = 0; split <= walls.size(); split++) {
+        EventLog log;
+        std::string err;
+        JsonEventParser parser(log, err);
+        CHECK(parser.feed(walls.substr(0, split)));
+        CHECK(parser.feed(walls.substr(split)));
+        CHECK(parser.finish());
+        CHECK_EQUAL(log.events, std::string(wallEvents));
+    }
+    EventLog log;
+    std::string err;
+    JsonEventParser parser(log, err);
+    for (char c: walls) {
+        // each chunk a copy that ends with it, as a reader's buffer would
+        std::string chunk(1, c);
+        CHECK(parser.feed(chunk));
+    }
+    CHECK(parser.finish());
+    CHECK_EQUAL(log.events, std::string(wallEvents));
+}
+
+TEST(jsonEventsFailLikeTree) {
+    std::string deep(201, '[');
+    for (std::string_view in: {std::string_view(""), std::string_view("[1,]"),
+                               std::string_view("{\"a\": 1 \"b\": 2}"), std::string_view("[1] 2"),
+                               std::string_view("tru"), std::string_view("\"\\uD800\"x"),
+                               std::string_view("[\"a\x01\"]"), std::string_view(deep)}) {
+        EventLog log;
+        std::string eventErr, treeErr;
+        JsonEventParser parser(log, eventErr);
+        bool valid = parser.feed(in) && parser.finish();
+        Json::parse(in, treeErr);
+        CHECK(!valid);
+        CHECK_EQUAL(eventErr, treeErr);
+        // and keeps failing
+        CHECK(!parser.feed("1"));
+        CHECK(!parser.finish());
+    }
+}
+
+TEST(jsonEventsWaitForTheEndOfTheInput) {
+    EventLog log;
+    std::string err;
+    JsonEventParser parser(log, err);
+    CHECK(parser.feed("[12"));
+    CHECK_EQUAL(log.events, std::string("[ "));
+    CHECK(parser.feed("3, tr"));
+    CHECK_EQUAL(log.events, std::string("[ 123 "));
+    // comments are only allowed with JsonParse::COMMENTS
+    CHECK(!parser.feed("ue] /* 1 */"));
+    CHECK_EQUAL(log.events, std::string("[ 123 true ] "));
+    std::string treeErr;
+    Json::parse("[123, true] /* 1 */", treeErr);
+    CHECK_EQUAL(err, treeErr);
+
+    EventLog number;
+    JsonEventParser trailing(number, err, json11::JsonParse::COMMENTS);
+    CHECK(trailing.feed("4"));
+    CHECK(trailing.feed("2 // answer"));
+    CHECK(trailing.finish());
+    CHECK_EQUAL(number.events, std::string("42 "));
+}
@@ -0,0 +1,50 @@
+#include <stdexcept>
+#include <string>
+
+#include "json11.hpp"
+#include "test.hpp"
+
+using json11::Json;
+using json11::JsonDocument;
+using json11::JsonMap;
+
+TEST(jsonMapKeepsKeysSorted) {
+    JsonMap map = {{"b", 2}, {"c", 3}, {"a", 1}};
+    REQUIRE(map.size() == 3u);
+    CHECK_EQUAL(map.begin()->first, std::string("a"));
+    CHECK_EQUAL(map.at("c").int_value(), 3);
+    CHECK(map.find("d") == map.end());
+    CHECK_THROWS(map.at("d"), std::out_of_range);
+
+    map["ab"] = 4;
+    CHECK(!map.insert({"ab", 5}).second);
+    CHECK_EQUAL(map["ab"].int_value(), 4);
+    CHECK_EQUAL(map.erase("b"), 1u);
+    CHECK_EQUAL(Json(map).dump(), std::string(R"({"a": 1, "ab": 4, "c": 3})"));
+}
+
+TEST(jsonMapInitializerListKeepsFirstRepeatedKey) {
+    // like std::map
+    JsonMap map = {{"x", 1}, {"y", 2}, {"x", 3}};
+    CHECK_EQUAL(map.size(), 2u);
+    CHECK_EQUAL(map.at("x").int_value(), 1);
+    Json object = Json::object {{"x", 1}, {"x", 3}};
+    CHECK_EQUAL(object["x"].int_value(), 1);
+}
+
+TEST(jsonParseKeepsLastRepeatedKey) {
+    std::string err;
+    Json json = Json::parse(R"({"x": 1, "y": 2, "x": 3, "a": 4, "x": 5})", err);
+    CHECK_EQUAL(err, std::string());
+    CHECK_EQUAL(json.object_items().size(), 3u);
+    CHECK_EQUAL(json["x"].int_value(), 5);
+    CHECK_EQUAL(json.dump(), std::string(R"({"a": 4, "x": 5, "y": 2})"));
+
+    // documents keep their members as parsed, and look up the last one too
+    JsonDocument document = JsonDocument::parse(R"({"x": 1, "y": 2, "x": 3, "a": 4, "x": 5})", err);
+    CHECK_EQUAL(err, std::string());
+    REQUIRE(document.root().size() == 5u);
+    CHECK_EQUAL(document.root().key(1), std::string_view("y"));
+    CHECK_EQUAL(document.root()["x"].int_value(), 5);
+    CHECK(document.root().to_json() == json);
+}
@@ -0,0 +1,54 @@
+#include "jsonreference.hpp"
+
+// also built by json11scalar.cpp, where json11 is renamed
+
+namespace json11 {
+
+// writes down every event, with values as Json::dump writes them
+class EventRecorder final : public JsonHandler {
+public:
+    std::string events;
+
+    void null_value() override { events += "null "; }
+    void bool_value(bool value) override { events += value ? "true " : "false "; }
+    void number_value(double value) override { write(Json(value)); }
+    void string_value(std::string_view value) override { write(Json(std::string(value))); }
+    void start_array() override { events += "[ "; }
+    void end_array() override { events += "] "; }
+    void start_object() override { events += "{ "; }
+    void key(std::string_view key) override {
+        write(Json(std::string(key)));
+        events += ": ";
+    }
+    void end_object() override { events += "} "; }
+
+private:
+    void write(const Json& value) {
+        value.dump(events);
+        events += ' ';
+    }
+};
+
+JsonParseResults parseWithEveryParser(std::string_view in, bool comments) {
+    JsonParse strategy = comments ? JsonParse::COMMENTS : JsonParse::STANDARD;
+    JsonParseResults results;
+    results.tree = Json::parse(in, results.treeError, strategy).dump();
+    JsonDocument document = JsonDocument::parse(in, results.documentError, strategy);
+    results.document = document.root().to_json().dump();
+
+    EventRecorder whole;
+    JsonEventParser::parse(in, whole, results.eventsError, strategy);
+    results.events = whole.events;
+
+    EventRecorder chunked;
+    JsonEventParser parser(chunked, results.chunkedEventsError, strategy);
+    bool valid = true;
+    for (size_t i = 0; valid && i < in.size(); i += 7)
+        valid = parser.feed(in.substr(i, 7));
+    if (valid)
+        parser.finish();
+    results.chunkedEvents = chunked.events;
+    return results;
+}
+
+} // namespace json11
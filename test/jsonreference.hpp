@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "json11.hpp"
+
+// what every json11 parser makes of an input, dumped, so two builds of them can be compared
+struct JsonParseResults {
+    std::string tree;
+    std::string treeError;
+    std::string document;
+    std::string documentError;
+    std::string events;
+    std::string eventsError;
+    // fed a few bytes at a time, so scans also stop at the end of each chunk
+    std::string chunkedEvents;
+    std::string chunkedEventsError;
+
+    bool operator==(const JsonParseResults& other) const = default;
+};
+
+namespace json11 {
+JsonParseResults parseWithEveryParser(std::string_view in, bool comments);
+}
+
+// the same parsers without their SSE2 and AVX2 block scans, from json11scalar.cpp
+namespace json11_scalar {
+JsonParseResults parseWithEveryParser(std::string_view in, bool comments);
+}
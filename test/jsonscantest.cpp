@@ -0,0 +1,77 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "jsonreference.hpp"
+#include "test.hpp"
+
+// every parser, with and without the block scans, in both modes; returns the first input they
+// disagree on, or an empty string
+static std::string firstDisagreement(std::string_view in) {
+    for (bool comments: {false, true}) {
+        if (!(json11::parseWithEveryParser(in, comments) == json11_scalar::parseWithEveryParser(in, comments)))
+            return (comments ? "COMMENTS: " : "STANDARD: ") + std::string(in);
+    }
+    return {};
+}
+
+// the same input cut at every length, so that it also ends inside blocks, strings and comments
+static std::string firstDisagreementOfPrefixes(std::string_view in) {
+    for (size_t length = 0; length <= in.size(); length++) {
+        std::string disagreement = firstDisagreement(in.substr(0, length));
+        if (!disagreement.empty())
+            return disagreement;
+    }
+    return {};
+}
+
+// inputs with whatever the scans stop at pushed along by shift bytes, onto and around every
+// 16 and 32 byte boundary
+static std::vector<std::string> shiftedInputs(size_t shift) {
+    std::string run(shift, 'a');
+    std::string whitespace;
+    for (size_t i = 0; i < shift; i++)
+        whitespace += " \t\r\n"[i % 4];
+    return {
+        whitespace + "[\"" + run + "\\\"\",\"" + run + "\\\\\"" + whitespace + "]",
+        "[\"" + run + "\\n\\u00e9\\ud83d\\ude00" + std::string(40 - shift, 'b') + "\"," + whitespace + "true]",
+        "{" + whitespace + "\"" + run + "key\"" + whitespace + ":" + whitespace + "-12.5e3" + whitespace + "}",
+        "[\"" + run + "\x01\"]",
+        "[\"" + run + "\x1f\"]",
+        "[\"" + run + "\t\"]",
+        "[\"" + run + "\x7f\x80\xff" + run + "\"]",
+        "[1," + whitespace + "/* " + run + " */" + whitespace + "// " + run + "\n2" + whitespace + "]",
+        "[" + whitespace + "\x0b" + "1]",
+    };
+}
+
+TEST(jsonBlockScansMatchScalarParser) {
+    std::string disagreement;
+    for (size_t shift = 0; shift <= 40 && disagreement.empty(); shift++) {
+        for (const std::string& input: shiftedInputs(shift)) {
+            disagreement = firstDisagreementOfPrefixes(input);
+            if (!disagreement.empty())
+                break;
+        }
+    }
+    CHECK_EQUAL(disagreement, std::string());
+}
+
+TEST(jsonBlockScansReadValidInputs) {
+    // the comparison above only means something if the inputs get past their first block
+    std::string err;
+    for (size_t shift: {0, 15, 16, 31, 32, 40}) {
+        std::vector<std::string> inputs = shiftedInputs(shift);
+        for (size_t i: {0, 1, 2, 6}) {
+            JsonParseResults results = json11::parseWithEveryParser(inputs[i], false);
+            CHECK_EQUAL(results.treeError, std::string());
+            CHECK_EQUAL(results.documentError, std::string());
+            CHECK_EQUAL(results.chunkedEventsError, std::string());
+            CHECK(results.tree == results.document);
+        }
+        JsonParseResults commented = json11::parseWithEveryParser(inputs[7], true);
+        CHECK_EQUAL(commented.tree, std::string("[1, 2]"));
+        CHECK_EQUAL(commented.events, std::string("[ 1 2 ] "));
+        CHECK(!json11::parseWithEveryParser(inputs[3], false).treeError.empty());
+    }
+}
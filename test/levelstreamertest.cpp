@@ -0,0 +1,87 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "level.hpp"
+#include "levelstreamer.hpp"
+#include "test.hpp"
+
+// a 1 by 1 wall every 200 meters along the x axis, and a cluster of five
+// walls sharing a chunk at 5000
+static std::string writeStreamedLevel() {
+    std::string json = R"({"walls": [)";
+    for (int i = -5; i <= 15; i++)
+        json += "{\"position\": [" + std::to_string(i * 200) + ", 0], \"size\": [1, 1]},";
+    for (int i = 0; i < 5; i++)
+        json += "{\"position\": [" + std::to_string(5000 + i * 2) + ", 4], \"size\": [1, 1]},";
+    json.pop_back();
+    json += "]}";
+
+    std::string path = (std::filesystem::temp_directory_path() / "rj-test-streamed.json").string();
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << json;
+    return path;
+}
+
+TEST(levelStreamerKeepsOnlyNearbyChunks) {
+    std::string path = writeStreamedLevel();
+    b2World world(b2Vec2{0, 0});
+    LevelStreamer streamer(world, ChunkedLevel(path));
+
+    std::vector<b2Vec2> focus = {{0, 0}};
+    streamer.update(focus);
+    streamer.finishLoading();
+    CHECK_EQUAL(streamer.loadedChunkCount(), 1u);
+    CHECK_EQUAL(streamer.wallCount(), 1u);
+    CHECK_EQUAL(world.GetBodyCount(), 1);
+
+    // a second focus brings its own chunk in
+    focus.push_back({1000, 0});
+    streamer.update(focus);
+    streamer.finishLoading();
+    CHECK_EQUAL(streamer.loadedChunkCount(), 2u);
+    CHECK_EQUAL(world.GetBodyCount(), 2);
+
+    // chunks out of range are dropped along with their bodies
+    focus = {{1600, 0}};
+    streamer.update(focus);
+    streamer.finishLoading();
+    CHECK_EQUAL(streamer.loadedChunkCount(), 1u);
+    CHECK_EQUAL(streamer.wallCount(), 1u);
+    CHECK_EQUAL(world.GetBodyCount(), 1);
+
+    // out of load distance, but not of unload distance
+    focus = {{1680, 0}};
+    streamer.update(focus);
+    CHECK_EQUAL(streamer.loadedChunkCount(), 1u);
+    CHECK_EQUAL(world.GetBodyCount(), 1);
+    focus = {{1720, 0}};
+    streamer.update(focus);
+    CHECK_EQUAL(streamer.loadedChunkCount(), 0u);
+    CHECK_EQUAL(world.GetBodyCount(), 0);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".cooked");
+}
+
+TEST(levelStreamerSpreadsBodiesOverUpdates) {
+    std::string path = writeStreamedLevel();
+    b2World world(b2Vec2{0, 0});
+    LevelStreamer streamer(world, ChunkedLevel(path), {.wallsPerUpdate = 2});
+
+    std::vector<b2Vec2> focus = {{5000, 0}};
+    size_t previous = 0;
+    for (int i = 0; i < 1000 && streamer.wallCount() < 5; i++) {
+        streamer.update(focus);
+        CHECK(streamer.wallCount() - previous <= 2);
+        previous = streamer.wallCount();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQUAL(streamer.wallCount(), 5u);
+    CHECK_EQUAL(world.GetBodyCount(), 5);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".cooked");
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hash.hpp"
+#include "level.hpp"
+#include "test.hpp"
+
+constexpr std::string_view twoWalls = R"({
+    "walls": [
+        {"position": [-10, 10], "size": [20, 5]},
+        {"position": [4, -2.5], "size": [1, 0.5], "color": "red"}
+    ]
+})";
+
+static std::string temporaryPath(const char *name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static void writeFile(const std::string& path, std::string_view contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+}
+
+static std::vector<std::array<float, 4>> sortedWalls(const Level& level) {
+    std::vector<std::array<float, 4>> walls;
+    for (const WallDefinition& wall: level.walls)
+        walls.push_back({wall.position.x, wall.position.y, wall.dimensions.x, wall.dimensions.y});
+    std::sort(walls.begin(), walls.end());
+    return walls;
+}
+
+// cooked levels group their walls by chunk, which reorders them
+static bool sameWalls(const Level& a, const Level& b) {
+    return sortedWalls(a) == sortedWalls(b);
+}
+
+TEST(levelParsesWalls) {
+    Level level = parseLevel(twoWalls);
+    REQUIRE(level.walls.size() == 2u);
+    CHECK(level.walls[1].position == b2Vec2(4, -2.5f));
+    CHECK(level.walls[1].dimensions == b2Vec2(1, 0.5f));
+
+    CHECK_THROWS(parseLevel(R"({"floors": []})"), std::runtime_error);
+    CHECK_THROWS(parseLevel(R"({"walls": [{"position": [0, 0]}]})"), std::runtime_error);
+    CHECK_THROWS(parseLevel(R"({"walls": [{"position": [0], "size": [1, 1]}]})"), std::runtime_error);
+    CHECK_THROWS(parseLevel(R"({"walls": [)"), std::runtime_error);
+}
+
+TEST(levelCacheIsCookedOnceAndReused) {
+    std::string path = temporaryPath("rj-test-cached.json");
+    std::string cookedPath = path + ".cooked";
+    writeFile(path, twoWalls);
+    std::filesystem::remove(cookedPath);
+
+    Level loaded = loadLevel(path);
+    CHECK(sameWalls(loaded, parseLevel(twoWalls)));
+    REQUIRE(std::filesystem::exists(cookedPath));
+    uint64_t sourceHash = fnv1a(twoWalls.data(), twoWalls.size());
+    std::optional<Level> cooked = readCookedLevel(cookedPath, sourceHash);
+    REQUIRE(cooked.has_value());
+    CHECK(sameWalls(*cooked, loaded));
+
+    // a cache matching the source is trusted over it, whatever it holds
+    Level other = {.walls = {{b2Vec2{1, 2}, b2Vec2{3, 4}}}};
+    REQUIRE(writeCookedLevel(cookedPath, other, sourceHash));
+    CHECK(sameWalls(loadLevel(path), other));
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(cookedPath);
+}
+
+TEST(levelCacheIsRecookedWhenStale) {
+    std::string path = temporaryPath("rj-test-stale.json");
+    std::string cookedPath = path + ".cooked";
+    writeFile(path, twoWalls);
+    loadLevel(path);
+
+    // an edited source no longer matches the hash in the cache
+    std::string edited = R"({"walls": [{"position": [0, 0], "size": [2, 2]}]})";
+    writeFile(path, edited);
+    uint64_t editedHash = fnv1a(edited.data(), edited.size());
+    CHECK(!readCookedLevel(cookedPath, editedHash).has_value());
+    CHECK(sameWalls(loadLevel(path), parseLevel(edited)));
+    CHECK(readCookedLevel(cookedPath, editedHash).has_value());
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(cookedPath);
+}
+
+TEST(levelCacheRejectsDamagedFiles) {
+    std::string cookedPath = temporaryPath("rj-test-damaged.cooked");
+    Level level = parseLevel(twoWalls);
+    REQUIRE(writeCookedLevel(cookedPath, level, 42));
+    CHECK(readCookedLevel(cookedPath, 42).has_value());
+    CHECK(!readCookedLevel(cookedPath, 43).has_value());
+
+    // a flipped bit in the walls fails the content hash
+    auto size = std::filesystem::file_size(cookedPath);
+    {
+        std::fstream file(cookedPath, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(size - 1);
+        char last = static_cast<char>(file.get());
+        file.seekp(size - 1);
+        file.put(static_cast<char>(last ^ 1));
+    }
+    CHECK(!readCookedLevel(cookedPath, 42).has_value());
+
+    REQUIRE(writeCookedLevel(cookedPath, level, 42));
+    std::filesystem::resize_file(cookedPath, size - 4);
+    CHECK(!readCookedLevel(cookedPath, 42).has_value());
+    std::filesystem::resize_file(cookedPath, 10);
+    CHECK(!readCookedLevel(cookedPath, 42).has_value());
+    CHECK(!readCookedLevel(temporaryPath("rj-test-missing.cooked"), 42).has_value());
+
+    std::filesystem::remove(cookedPath);
+}
@@ -0,0 +1,57 @@
+#include "pool.hpp"
+#include "test.hpp"
+
+// counts how many instances are alive, to catch missed or doubled destructor calls
+struct Counted {
+    static inline int alive = 0;
+    int value;
+
+    explicit Counted(int value): value(value) { alive++; }
+    ~Counted() { alive--; }
+};
+
+TEST(poolFillsLowestSlotsFirst) {
+    Pool<Counted> pool(3);
+    Counted *a = pool.create(1);
+    Counted *b = pool.create(2);
+    CHECK_EQUAL(pool.indexOf(a), 0u);
+    CHECK_EQUAL(pool.indexOf(b), 1u);
+    CHECK_EQUAL(pool.size(), 2u);
+    CHECK(pool.at(0) == a);
+    CHECK(pool.at(2) == nullptr);
+    pool.destroy(a);
+    pool.destroy(b);
+}
+
+TEST(poolReturnsNullWhenFull) {
+    Pool<Counted> pool(2);
+    Counted *a = pool.create(1);
+    Counted *b = pool.create(2);
+    CHECK(pool.create(3) == nullptr);
+    CHECK_EQUAL(Counted::alive, 2);
+
+    // a freed slot is taken again, without moving the other object
+    pool.destroy(a);
+    CHECK_EQUAL(pool.size(), 1u);
+    Counted *c = pool.create(4);
+    REQUIRE(c != nullptr);
+    CHECK_EQUAL(pool.indexOf(c), 0u);
+    CHECK_EQUAL(b->value, 2);
+    CHECK_EQUAL(c->value, 4);
+    pool.destroy(b);
+    pool.destroy(c);
+    CHECK_EQUAL(Counted::alive, 0);
+}
+
+TEST(poolDestroysWhatIsLeft) {
+    {
+        Pool<Counted> pool(4);
+        pool.create(1);
+        Counted *b = pool.create(2);
+        pool.create(3);
+        pool.destroy(b);
+        pool.destroy(nullptr);
+        CHECK_EQUAL(Counted::alive, 2);
+    }
+    CHECK_EQUAL(Counted::alive, 0);
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json11.hpp"
+#include "profiler.hpp"
+#include "test.hpp"
+
+// only records anything when built with `make PROFILE=1 test`
+
+static void profiledWork() {
+    RJ_PROFILE_SCOPE("profiledWork");
+    RJ_PROFILE_SCOPE("nestedWork");
+}
+
+static size_t countNamed(const std::vector<ProfileRecord>& records, const std::string& name) {
+    return std::count_if(records.begin(), records.end(), [&](const ProfileRecord& record) {
+        return record.name == name;
+    });
+}
+
+TEST(profilerDrainsEveryThread) {
+    std::vector<ProfileRecord> records;
+    drainProfileRecords(records);
+    records.clear();
+
+    profiledWork();
+    std::thread(profiledWork).join();
+    CHECK_EQUAL(drainProfileRecords(records), 0u);
+    if (!PROFILER_ENABLED) {
+        CHECK(records.empty());
+        return;
+    }
+    CHECK_EQUAL(countNamed(records, "profiledWork"), 2u);
+    CHECK_EQUAL(countNamed(records, "nestedWork"), 2u);
+    for (const ProfileRecord& record: records)
+        CHECK(record.begin <= record.end);
+
+    // drained events aren't returned twice
+    records.clear();
+    drainProfileRecords(records);
+    CHECK_EQUAL(countNamed(records, "profiledWork"), 0u);
+}
+
+TEST(profilerWritesChromeTraces) {
+    profiledWork();
+    std::ostringstream out;
+    writeChromeTrace(out);
+
+    std::string error;
+    json11::Json trace = json11::Json::parse(out.str(), error);
+    REQUIRE(error.empty());
+    REQUIRE(trace["traceEvents"].is_array());
+    const auto& events = trace["traceEvents"].array_items();
+    bool found = std::any_of(events.begin(), events.end(), [](const json11::Json& event) {
+        return event["name"].string_value() == "profiledWork";
+    });
+    CHECK_EQUAL(found, PROFILER_ENABLED);
+}
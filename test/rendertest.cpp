@@ -0,0 +1,106 @@
+#include <cmath>
+
+#include "rendercommands.hpp"
+#include "simulation.hpp"
+#include "world.hpp"
+#include "test.hpp"
+
+using Type = RenderCommand::Type;
+
+static b2AABB around(b2Vec2 center, float extent) {
+    b2Vec2 margin = {extent, extent};
+    return {center - margin, center + margin};
+}
+
+TEST(renderCommandsSortByLayerThenType) {
+    RenderCommandBuffer commands;
+    commands.setLayer(RenderLayer::WALLS);
+    commands.rectangleLines({0, 0, 10, 10}, WHITE);
+    commands.setLayer(RenderLayer::EXPLOSIONS);
+    commands.circleLines({1, 1}, 2, BLUE);
+    commands.circle({2, 2}, 2, BLUE);
+    commands.setLayer(RenderLayer::PLAYERS);
+    commands.circle({3, 3}, 1, RED);
+    commands.setLayer(RenderLayer::EXPLOSIONS);
+    commands.circle({4, 4}, 2, BLUE);
+    commands.sort();
+
+    auto view = commands.view();
+    REQUIRE(view.size() == 5u);
+    CHECK(view[0].layer == RenderLayer::EXPLOSIONS && view[0].type == Type::CIRCLE);
+    CHECK_EQUAL(view[0].circle.center.x, 2.0f);
+    CHECK(view[1].layer == RenderLayer::EXPLOSIONS && view[1].type == Type::CIRCLE);
+    CHECK_EQUAL(view[1].circle.center.x, 4.0f);
+    CHECK(view[2].layer == RenderLayer::EXPLOSIONS && view[2].type == Type::CIRCLE_LINES);
+    CHECK(view[3].layer == RenderLayer::PLAYERS && view[3].type == Type::CIRCLE);
+    CHECK(view[4].layer == RenderLayer::WALLS && view[4].type == Type::RECTANGLE_LINES);
+    CHECK_EQUAL(commands.count(Type::CIRCLE), 3u);
+
+    commands.clear();
+    CHECK_EQUAL(commands.size(), 0u);
+}
+
+TEST(interpolateUsesToWhenTypesDiffer) {
+    RenderCommandBuffer from, to, moved;
+    from.circle({0, 0}, 1, RED);
+    from.circle({0, 0}, 1, RED);
+    to.circle({2, 2}, 1, RED);
+    to.circle({2, 2}, 1, RED);
+    moved.interpolate(from, to, 0.5f);
+    REQUIRE(moved.size() == 2u);
+    CHECK_EQUAL(moved.view()[0].circle.center.x, 1.0f);
+    CHECK_EQUAL(moved.view()[1].circle.center.x, 1.0f);
+
+    // only the last one differs, the first must not be moved either
+    from.clear();
+    from.circle({0, 0}, 1, RED);
+    from.circleLines({0, 0}, 1, RED);
+    moved.interpolate(from, to, 0.5f);
+    REQUIRE(moved.size() == 2u);
+    CHECK_EQUAL(moved.view()[0].circle.center.x, 2.0f);
+    CHECK_EQUAL(moved.view()[1].circle.center.x, 2.0f);
+}
+
+TEST(renderCullsWhatIsOutOfView) {
+    Simulation simulation;
+    for (int i = 0; i < 120; i++)
+        simulation.step();
+    b2Vec2 player = simulation.getPlayer().box2dPosition();
+    TickInput input;
+    input.target = player + b2Vec2{100, -100};
+    input.leftPressed = true;
+    simulation.applyInput(0, input);
+    constexpr int flightTicks = 15;
+    for (int i = 0; i < flightTicks; i++)
+        simulation.step();
+    // straight up and to the right, without gravity
+    float flown = 30.0f * flightTicks * SIMULATION_STEP_INTERVAL;
+    b2Vec2 rocket = player + flown * std::sqrt(0.5f) * b2Vec2{1, -1};
+
+    RenderCommandBuffer everything;
+    simulation.render(everything);
+    CHECK_EQUAL(everything.count(Type::TRIANGLE_LINES), 1u);
+    CHECK_EQUAL(everything.count(Type::CACHED_LAYER), 1u);
+    RenderCommandBuffer playerOnly;
+    simulation.getPlayer().render(playerOnly, 1.0f);
+    REQUIRE(playerOnly.size() > 0u);
+
+    RenderCommandBuffer commands;
+    b2AABB nowhere = around({500, -500}, 10);
+    simulation.render(commands, 1.0f, &nowhere);
+    CHECK_EQUAL(commands.size(), 0u);
+
+    // over the player, clear of the ground under it
+    b2AABB overPlayer = around(player - b2Vec2{0, 0.5f}, 0.2f);
+    commands.clear();
+    simulation.render(commands, 1.0f, &overPlayer);
+    CHECK_EQUAL(commands.size(), playerOnly.size());
+    CHECK_EQUAL(commands.count(Type::TRIANGLE_LINES), 0u);
+    CHECK_EQUAL(commands.count(Type::CACHED_LAYER), 0u);
+
+    b2AABB overRocket = around(rocket, 1.0f);
+    commands.clear();
+    simulation.render(commands, 1.0f, &overRocket);
+    CHECK_EQUAL(commands.size(), 1u);
+    CHECK_EQUAL(commands.count(Type::TRIANGLE_LINES), 1u);
+}
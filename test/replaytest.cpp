@@ -0,0 +1,150 @@
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "headless.hpp"
+#include "replay.hpp"
+#include "test.hpp"
+
+constexpr uint64_t recordedTicks = 1500;
+constexpr uint32_t keyframeInterval = 600;
+// between keyframes, so seeking there has to simulate part of the way
+constexpr uint64_t seekTick = 900;
+constexpr SimulationOptions recordedOptions = {.timerWheel = true};
+
+static std::string temporaryPath(const char *name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static std::vector<uint8_t> stateOf(const Simulation& simulation) {
+    std::vector<uint8_t> state;
+    simulation.saveState(state);
+    return state;
+}
+
+// records the scripted input, returning the state the simulation ended in,
+// and the one it had at seekTick if asked
+static std::vector<uint8_t> recordScripted(const std::string& path, std::vector<uint8_t> *atSeekTick = nullptr) {
+    Simulation simulation(2, recordedOptions);
+    ReplayWriter writer(path, simulation, keyframeInterval);
+    for (uint64_t i = 0; i < recordedTicks; i++) {
+        if (atSeekTick != nullptr && simulation.tick() == seekTick)
+            *atSeekTick = stateOf(simulation);
+        for (size_t player = 0; player < simulation.playerCount(); player++) {
+            TickInput input = scriptedInput(simulation.tick() + player);
+            simulation.applyInput(player, input);
+            writer.recordInput(simulation, player, input);
+        }
+        simulation.step();
+        writer.afterStep(simulation);
+    }
+    writer.finish();
+    return stateOf(simulation);
+}
+
+static void playToEnd(ReplayReader& reader, Simulation& simulation) {
+    while (simulation.tick() < reader.length()) {
+        reader.applyInputs(simulation);
+        simulation.step();
+    }
+}
+
+TEST(replayStateRoundTrips) {
+    Simulation original(2);
+    for (int i = 0; i < 300; i++) {
+        original.applyInput(0, scriptedInput(original.tick()));
+        original.step();
+    }
+    std::vector<uint8_t> state = stateOf(original);
+
+    Simulation copy(2);
+    copy.loadState(state.data(), state.size());
+    CHECK_EQUAL(copy.tick(), original.tick());
+    CHECK(stateOf(copy) == state);
+
+    Simulation other(3);
+    CHECK_THROWS(other.loadState(state.data(), state.size()), std::invalid_argument);
+}
+
+TEST(replayPlaysBackWhatWasRecorded) {
+    std::string path = temporaryPath("rj-test-playback.rjr");
+    std::vector<uint8_t> recorded = recordScripted(path);
+
+    ReplayReader reader(path);
+    CHECK_EQUAL(reader.length(), recordedTicks);
+    CHECK_EQUAL(reader.playerCount(), 2u);
+    CHECK(reader.getSimulationOptions().timerWheel);
+    CHECK_EQUAL(reader.loadRecordedLevel().hash(), Level::builtin().hash());
+
+    Simulation simulation(reader.playerCount(), reader.getSimulationOptions());
+    reader.seek(simulation, 0);
+    playToEnd(reader, simulation);
+    CHECK(stateOf(simulation) == recorded);
+    std::filesystem::remove(path);
+}
+
+TEST(replaySeeksReproducibly) {
+    std::string path = temporaryPath("rj-test-seek.rjr");
+    std::vector<uint8_t> recordedAtSeekTick;
+    std::vector<uint8_t> recorded = recordScripted(path, &recordedAtSeekTick);
+    REQUIRE(!recordedAtSeekTick.empty());
+    ReplayReader reader(path);
+
+    Simulation forward(2, recordedOptions);
+    reader.seek(forward, seekTick);
+    CHECK_EQUAL(forward.tick(), seekTick);
+    CHECK(stateOf(forward) == recordedAtSeekTick);
+    playToEnd(reader, forward);
+    CHECK(stateOf(forward) == recorded);
+
+    // seeking backwards goes through the same keyframe, whatever the world went through
+    Simulation backward(2, recordedOptions);
+    reader.seek(backward, 1400);
+    reader.seek(backward, seekTick);
+    CHECK(stateOf(backward) == recordedAtSeekTick);
+    playToEnd(reader, backward);
+    CHECK(stateOf(backward) == recorded);
+    std::filesystem::remove(path);
+}
+
+static void writeFile(const std::string& path, std::string_view contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+}
+
+TEST(replayPlaysOnTheLevelItWasRecordedOn) {
+    std::string levelPath = temporaryPath("rj-test-replay-level.json");
+    std::string path = temporaryPath("rj-test-level.rjr");
+    writeFile(levelPath, R"({"walls": [{"position": [-10, 10], "size": [20, 5]}, {"position": [2, 5], "size": [1, 1]}]})");
+    Level level = loadLevel(levelPath);
+    {
+        Simulation simulation(1, {}, level);
+        ReplayWriter writer(path, simulation, keyframeInterval, levelPath, level);
+        for (int i = 0; i < 10; i++) {
+            simulation.step();
+            writer.afterStep(simulation);
+        }
+    }
+
+    ReplayReader reader(path);
+    CHECK_EQUAL(reader.loadRecordedLevel().hash(), level.hash());
+    CHECK(reader.loadRecordedLevel().hash() != Level::builtin().hash());
+
+    // edited since, playing it back would go out of sync
+    writeFile(levelPath, R"({"walls": [{"position": [-10, 10], "size": [20, 5]}]})");
+    CHECK_THROWS(reader.loadRecordedLevel(), std::runtime_error);
+    std::filesystem::remove(levelPath);
+    std::filesystem::remove(levelPath + ".cooked");
+    std::filesystem::remove(path);
+}
+
+TEST(replayRejectsTruncatedFiles) {
+    std::string path = temporaryPath("rj-test-truncated.rjr");
+    recordScripted(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    CHECK_THROWS(ReplayReader{path}, std::runtime_error);
+    std::filesystem::remove(path);
+}
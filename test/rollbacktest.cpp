@@ -0,0 +1,117 @@
+#include <deque>
+
+#include "headless.hpp"
+#include "rollbacksession.hpp"
+#include "simulation.hpp"
+#include "transport.hpp"
+#include "world.hpp"
+#include "test.hpp"
+
+constexpr uint64_t scriptedTicks = 600;
+constexpr uint64_t idleTicks = 60;
+constexpr uint64_t playerScriptOffset = 7;
+
+// the script, then idling while aiming where it last did, which is exactly
+// what the peer predicts, so the end state doesn't wait on confirmations
+static TickInput inputFor(size_t player, uint64_t tick) {
+    if (tick < scriptedTicks)
+        return scriptedInput(tick + player * playerScriptOffset);
+    TickInput idle;
+    idle.target = scriptedInput(scriptedTicks - 1 + player * playerScriptOffset).target;
+    return idle;
+}
+
+// plays the scripted match between two sessions over a link with latency and jitter
+static void playMatch(std::deque<Simulation>& simulations, std::deque<RollbackSession>& sessions, RollbackOptions options) {
+    LoopbackLink link({.latency = 0.06f, .jitter = 0.03f});
+    for (size_t peer = 0; peer < 2; peer++) {
+        simulations.emplace_back(2);
+        sessions.emplace_back(simulations.back(), peer, link.endpoint(peer), options);
+    }
+    constexpr uint64_t ticks = scriptedTicks + idleTicks;
+    while (simulations[0].tick() < ticks || simulations[1].tick() < ticks) {
+        for (size_t peer = 0; peer < 2; peer++) {
+            if (simulations[peer].tick() >= ticks) continue;
+            // local input is applied inputDelay ticks from now
+            sessions[peer].advance(inputFor(peer, simulations[peer].tick() + options.inputDelay));
+        }
+        link.advance(SIMULATION_STEP_INTERVAL);
+    }
+}
+
+// steps the same inputs without a session, rebuilding the world every rebuildInterval ticks
+// if given one
+static void playStraight(Simulation& simulation, RollbackOptions options, uint32_t rebuildInterval) {
+    while (simulation.tick() < scriptedTicks + idleTicks) {
+        if (rebuildInterval != 0 && simulation.tick() % rebuildInterval == 0)
+            simulation.rebuildWorld();
+        for (size_t player = 0; player < 2; player++) {
+            if (simulation.tick() >= options.inputDelay)
+                simulation.applyInput(player, inputFor(player, simulation.tick()));
+        }
+        simulation.step();
+    }
+}
+
+TEST(rollbackMatchesStraightRun) {
+    for (uint32_t rebuildInterval: {1u, RollbackOptions{}.rebuildInterval}) {
+        RollbackOptions options = {.rebuildInterval = rebuildInterval};
+        std::deque<Simulation> simulations;
+        std::deque<RollbackSession> sessions;
+        playMatch(simulations, sessions, options);
+
+        // the world rebuilt on the same ticks as the sessions do
+        Simulation straight(2);
+        playStraight(straight, options, rebuildInterval);
+        Snapshot expected;
+        straight.saveSnapshot(expected);
+        for (size_t peer = 0; peer < 2; peer++) {
+            CHECK(sessions[peer].getStats().rollbacks > 0);
+            CHECK(!sessions[peer].desyncTick());
+            Snapshot actual;
+            simulations[peer].saveSnapshot(actual);
+            CHECK_EQUAL(actual.checksum(), expected.checksum());
+        }
+    }
+}
+
+TEST(rollbackPlaysLikePlainSimulation) {
+    RollbackOptions options;
+    std::deque<Simulation> simulations;
+    std::deque<RollbackSession> sessions;
+    playMatch(simulations, sessions, options);
+
+    // never rebuilt, rebuilding drops Box2D's warm starting so only rounding may differ
+    Simulation plain(2);
+    playStraight(plain, options, 0);
+    for (size_t peer = 0; peer < 2; peer++) {
+        CHECK_EQUAL(simulations[peer].tick(), plain.tick());
+        for (size_t player = 0; player < 2; player++) {
+            const Player& expected = plain.getPlayer(player);
+            const Player& actual = simulations[peer].getPlayer(player);
+            CHECK((actual.box2dPosition() - expected.box2dPosition()).Length() < 0.1f);
+            CHECK_EQUAL(actual.getRocketAmmo(), expected.getRocketAmmo());
+        }
+    }
+}
+
+TEST(rebuildingTheWorldTwiceChangesNothing) {
+    Simulation once(2);
+    Simulation twice(2);
+    for (uint64_t tick = 0; tick < 300; tick++) {
+        once.rebuildWorld();
+        twice.rebuildWorld();
+        twice.rebuildWorld();
+        for (size_t player = 0; player < 2; player++) {
+            once.applyInput(player, inputFor(player, tick));
+            twice.applyInput(player, inputFor(player, tick));
+        }
+        once.step();
+        twice.step();
+    }
+    Snapshot expected;
+    Snapshot actual;
+    once.saveSnapshot(expected);
+    twice.saveSnapshot(actual);
+    CHECK(actual == expected);
+}
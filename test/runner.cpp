@@ -0,0 +1,66 @@
+#include <exception>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "test.hpp"
+
+/*
+ * Runs every registered test, or only the ones whose name contains one of
+ * the arguments, and exits with 1 if any of them failed.
+ *
+ * usage: rj-test [filter...]
+ */
+
+struct RegisteredTest {
+    const char *name;
+    TestFunction function;
+};
+
+// a function local static, tests register themselves during static
+// initialization, in no particular order between files
+std::vector<RegisteredTest>& registeredTests() {
+    static std::vector<RegisteredTest> tests;
+    return tests;
+}
+
+static int failuresInTest = 0;
+
+bool registerTest(const char *name, TestFunction function) {
+    registeredTests().push_back({name, function});
+    return true;
+}
+
+void reportFailure(const char *file, int line, const std::string& message) {
+    std::cout << "    " << file << ":" << line << ": " << message << "\n";
+    failuresInTest++;
+}
+
+bool selected(std::string_view name, int argc, char **argv) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (name.find(argv[i]) != std::string_view::npos)
+            return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    int passed = 0;
+    int failed = 0;
+    for (const RegisteredTest& test: registeredTests()) {
+        if (!selected(test.name, argc, argv)) continue;
+        failuresInTest = 0;
+        try {
+            test.function();
+        } catch (const TestAborted&) {
+            // already reported
+        } catch (const std::exception& e) {
+            reportFailure(test.name, 0, std::string("unexpected exception: ") + e.what());
+        }
+        std::cout << (failuresInTest == 0 ? "ok   " : "FAIL ") << test.name << std::endl;
+        (failuresInTest == 0 ? passed : failed)++;
+    }
+    std::cout << passed << " passed, " << failed << " failed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
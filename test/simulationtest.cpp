@@ -0,0 +1,63 @@
+#include "headless.hpp"
+#include "rendercommands.hpp"
+#include "simulation.hpp"
+#include "test.hpp"
+
+static void stepScripted(Simulation& simulation, uint64_t ticks) {
+    for (uint64_t i = 0; i < ticks; i++) {
+        for (size_t player = 0; player < simulation.playerCount(); player++)
+            simulation.applyInput(player, scriptedInput(simulation.tick()));
+        simulation.step();
+    }
+}
+
+TEST(simulationCountsTicks) {
+    Simulation simulation;
+    CHECK_EQUAL(simulation.tick(), 0u);
+    stepScripted(simulation, 10);
+    CHECK_EQUAL(simulation.tick(), 10u);
+}
+
+TEST(simulationIsDeterministic) {
+    Simulation first(2);
+    Simulation second(2);
+    stepScripted(first, 600);
+    stepScripted(second, 600);
+
+    for (size_t player = 0; player < 2; player++) {
+        const Player& a = first.getPlayer(player);
+        const Player& b = second.getPlayer(player);
+        CHECK(a.box2dPosition() == b.box2dPosition());
+        CHECK_EQUAL(a.getRocketAmmo(), b.getRocketAmmo());
+    }
+}
+
+TEST(simulationPlayersFall) {
+    Simulation simulation;
+    b2Vec2 start = simulation.getPlayer().box2dPosition();
+    for (int i = 0; i < 10; i++)
+        simulation.step();
+    CHECK(simulation.getPlayer().box2dPosition().y > start.y);
+}
+
+// the walls in the cached wall layer of a frame
+static size_t cachedWallCount(const Simulation& simulation) {
+    RenderCommandBuffer commands;
+    simulation.render(commands);
+    size_t walls = 0;
+    for (const RenderCommand& command: commands.view())
+        if (command.type == RenderCommand::Type::CACHED_LAYER)
+            walls += commands.getCachedLayer(command)->commands.count(RenderCommand::Type::RECTANGLE_LINES);
+    return walls;
+}
+
+TEST(simulationDrawsAddedWalls) {
+    Simulation simulation;
+    size_t walls = cachedWallCount(simulation);
+    REQUIRE(walls > 0u);
+
+    // added between steps, after the wall layer was cached
+    simulation.addWall({20, 0}, {2, 2});
+    simulation.step();
+    CHECK_EQUAL(cachedWallCount(simulation), walls + 1);
+}
@@ -0,0 +1,39 @@
+#include "smallvector.hpp"
+#include "test.hpp"
+
+TEST(smallVectorStaysInlineUpToItsSize) {
+    SmallVector<int, 4> items;
+    CHECK(items.empty());
+    for (int i = 0; i < 4; i++)
+        items.push_back(i);
+    CHECK_EQUAL(items.size(), 4u);
+    CHECK(!items.spilled());
+    CHECK_EQUAL(items[3], 3);
+}
+
+TEST(smallVectorSpillsOverKeepingItsItems) {
+    SmallVector<int, 4> items;
+    for (int i = 0; i < 10; i++)
+        items.push_back(i * i);
+    CHECK(items.spilled());
+    REQUIRE(items.size() == 10u);
+    int expected = 0;
+    for (int item: items) {
+        CHECK_EQUAL(item, expected * expected);
+        expected++;
+    }
+    CHECK_EQUAL(items.end() - items.begin(), 10);
+}
+
+TEST(smallVectorKeepsItsHeapBufferAcrossClear) {
+    SmallVector<int, 2> items;
+    for (int i = 0; i < 8; i++)
+        items.push_back(i);
+    const int *buffer = items.begin();
+    items.clear();
+    CHECK(items.empty());
+    for (int i = 0; i < 8; i++)
+        items.push_back(-i);
+    CHECK(items.begin() == buffer);
+    CHECK_EQUAL(items[7], -7);
+}
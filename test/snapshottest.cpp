@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "headless.hpp"
+#include "simulation.hpp"
+#include "test.hpp"
+
+static std::vector<uint32_t> nearbyExplosions(const Simulation& simulation, size_t player = 0) {
+    const SparseSet& nearby = simulation.getPlayer(player).getNearbyExplosions();
+    std::vector<uint32_t> slots(nearby.begin(), nearby.end());
+    std::sort(slots.begin(), slots.end());
+    return slots;
+}
+
+// lands the player and fires a rocket into the ground under it, stopping
+// right after the explosion is spawned, before Box2D reports it touching
+static void explodeUnderPlayer(Simulation& simulation) {
+    for (int i = 0; i < 120; i++)
+        simulation.step();
+    TickInput input;
+    input.target = simulation.getPlayer().box2dPosition() + b2Vec2{0, 100};
+    input.leftPressed = true;
+    simulation.applyInput(0, input);
+    while (simulation.getExplosions().size() == 0)
+        simulation.step();
+}
+
+TEST(snapshotRoundTripsBytes) {
+    Simulation simulation(2);
+    for (int i = 0; i < 400; i++) {
+        simulation.applyInput(0, scriptedInput(simulation.tick()));
+        simulation.applyInput(1, scriptedInput(simulation.tick() + 7));
+        simulation.step();
+    }
+    Snapshot saved;
+    simulation.saveSnapshot(saved);
+    CHECK_EQUAL(saved.size(), simulation.snapshotSize());
+
+    for (int i = 0; i < 50; i++) {
+        simulation.applyInput(0, scriptedInput(simulation.tick()));
+        simulation.step();
+    }
+    simulation.loadSnapshot(saved);
+    Snapshot reloaded;
+    simulation.saveSnapshot(reloaded);
+    CHECK(reloaded == saved);
+    CHECK_EQUAL(reloaded.checksum(), saved.checksum());
+
+    Simulation other(3);
+    CHECK_THROWS(other.loadSnapshot(saved), std::invalid_argument);
+}
+
+TEST(snapshotOfNewExplosionStillPushesPlayer) {
+    Simulation straight;
+    explodeUnderPlayer(straight);
+    REQUIRE(nearbyExplosions(straight).empty());
+    Snapshot snapshot;
+    straight.saveSnapshot(snapshot);
+
+    // the loaded simulation has been touching the explosion for a while
+    Simulation loaded;
+    explodeUnderPlayer(loaded);
+    for (int i = 0; i < 10; i++)
+        loaded.step();
+    REQUIRE(!nearbyExplosions(loaded).empty());
+    loaded.loadSnapshot(snapshot);
+    CHECK(nearbyExplosions(loaded).empty());
+
+    bool reached = false;
+    for (int i = 0; i < 90; i++) {
+        straight.step();
+        loaded.step();
+        CHECK(nearbyExplosions(loaded) == nearbyExplosions(straight));
+        reached = reached || !nearbyExplosions(loaded).empty();
+    }
+    CHECK(reached);
+}
+
+TEST(snapshotDropsOverlapsThatEnded) {
+    Simulation straight;
+    explodeUnderPlayer(straight);
+    Simulation loaded;
+    explodeUnderPlayer(loaded);
+
+    // loading the snapshot of every tick and stepping once must give the
+    // straight run's overlaps, including on the tick the recoil carries the
+    // player out of reach, when the snapshot still has the overlaps
+    Snapshot snapshot;
+    bool left = false;
+    for (int i = 0; i < 40; i++) {
+        if (i == 10) {
+            TickInput input;
+            input.target = straight.getPlayer().box2dPosition() + b2Vec2{30, 0};
+            input.rightPressed = true;
+            straight.applyInput(0, input);
+        } else if (i == 20) {
+            TickInput input;
+            input.target = straight.getPlayer().box2dPosition() + b2Vec2{30, 0};
+            input.rightReleased = true;
+            straight.applyInput(0, input);
+        }
+        straight.saveSnapshot(snapshot);
+        bool wasNearby = !nearbyExplosions(straight).empty();
+        straight.step();
+        loaded.loadSnapshot(snapshot);
+        loaded.step();
+        CHECK(nearbyExplosions(loaded) == nearbyExplosions(straight));
+        left = left || (wasNearby && nearbyExplosions(straight).empty());
+    }
+    REQUIRE(straight.getExplosions().size() > 0);
+    CHECK(left);
+}
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <vector>
+
+#include "sparseset.hpp"
+#include "test.hpp"
+
+static std::vector<uint32_t> sorted(const SparseSet& set) {
+    std::vector<uint32_t> members(set.begin(), set.end());
+    std::sort(members.begin(), members.end());
+    return members;
+}
+
+TEST(sparseSetInsertsOnce) {
+    SparseSet set(16);
+    CHECK(set.insert(3));
+    CHECK(set.insert(15));
+    CHECK(!set.insert(3));
+    CHECK_EQUAL(set.size(), 2u);
+    CHECK(set.contains(15));
+    CHECK(!set.contains(4));
+    CHECK_EQUAL(set.capacity(), 16u);
+}
+
+TEST(sparseSetErasesFromTheMiddle) {
+    SparseSet set(8);
+    for (uint32_t value: {5, 1, 7, 2})
+        set.insert(value);
+    CHECK(set.erase(1));
+    CHECK(!set.erase(1));
+    CHECK(!set.contains(1));
+    CHECK((sorted(set) == std::vector<uint32_t>{2, 5, 7}));
+    // the member moved into the hole can still be found and erased
+    CHECK(set.erase(2));
+    CHECK((sorted(set) == std::vector<uint32_t>{5, 7}));
+}
+
+TEST(sparseSetIgnoresStalePositions) {
+    SparseSet set(8);
+    set.insert(6);
+    set.insert(4);
+    set.clear();
+    CHECK_EQUAL(set.size(), 0u);
+    CHECK(!set.contains(6));
+    // 4 now takes the position 6 used to have
+    set.insert(4);
+    CHECK(!set.contains(6));
+    CHECK(!set.contains(100));
+    CHECK(set.insert(6));
+    CHECK((sorted(set) == std::vector<uint32_t>{4, 6}));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+/*
+ * Minimal test harness, so the tests build with nothing but the compiler.
+ *
+ * TEST(name) defines a case, which registers itself before main() runs.
+ * CHECK and CHECK_EQUAL record a failure and let the case go on, REQUIRE
+ * ends it, for when whatever follows would crash on a failed condition.
+ */
+
+using TestFunction = void (*)();
+
+bool registerTest(const char *name, TestFunction function);
+void reportFailure(const char *file, int line, const std::string& message);
+
+// thrown by REQUIRE, caught by the runner
+struct TestAborted {};
+
+template<typename A, typename B>
+void checkEqual(const A& actual, const B& expected, const char *expression, const char *file, int line) {
+    if (actual == expected) return;
+    std::ostringstream message;
+    message << expression;
+    if constexpr (requires { message << actual << expected; })
+        message << " (" << actual << " != " << expected << ")";
+    reportFailure(file, line, message.str());
+}
+
+#define TEST(name) \
+    static void name(); \
+    static const bool name##Registered = registerTest(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    ((condition) ? void() : reportFailure(__FILE__, __LINE__, #condition))
+
+#define CHECK_EQUAL(actual, expected) \
+    checkEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression, exception) \
+    do { \
+        bool thrown = false; \
+        try { expression; } catch (const exception&) { thrown = true; } \
+        if (!thrown) reportFailure(__FILE__, __LINE__, #expression " doesn't throw " #exception); \
+    } while (false)
+
+#define REQUIRE(condition) \
+    do { \
+        if (!(condition)) { \
+            reportFailure(__FILE__, __LINE__, #condition); \
+            throw TestAborted{}; \
+        } \
+    } while (false)
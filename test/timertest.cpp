@@ -0,0 +1,116 @@
+#include <optional>
+
+#include "inplacefunction.hpp"
+#include "timer.hpp"
+#include "timerwheel.hpp"
+#include "test.hpp"
+
+// a power of two, so tick counts come out exact
+constexpr float tickInterval = 0.125f;
+
+TEST(inplaceFunctionCallsItsTarget) {
+    InplaceFunction<int(int)> empty;
+    CHECK(!empty);
+
+    int offset = 3;
+    InplaceFunction<int(int)> add = [offset](int value) { return value + offset; };
+    CHECK(static_cast<bool>(add));
+    CHECK_EQUAL(add(4), 7);
+
+    // copies are independent of the original
+    InplaceFunction<int(int)> copy = add;
+    add = [](int value) { return -value; };
+    CHECK_EQUAL(copy(4), 7);
+    CHECK_EQUAL(add(4), -4);
+}
+
+TEST(inplaceFunctionTakesFunctionPointers) {
+    InplaceFunction<int()> function = +[]() { return 42; };
+    CHECK_EQUAL(function(), 42);
+}
+
+TEST(timerWheelFiresOnTheRightTick) {
+    TimerWheel wheel(tickInterval);
+    int fired = 0;
+    Timer timer(0.5f, [&fired]() { fired++; }, &wheel);
+    CHECK_EQUAL(wheel.ticksFor(0.5f), 4u);
+    for (int i = 0; i < 3; i++)
+        wheel.advance();
+    CHECK_EQUAL(fired, 0);
+    CHECK(!timer.done());
+    wheel.advance();
+    CHECK_EQUAL(fired, 1);
+    CHECK(timer.done());
+    CHECK_EQUAL(timer.progress(), 1.0f);
+    // only once, until it's reset
+    for (int i = 0; i < 8; i++)
+        wheel.advance();
+    CHECK_EQUAL(fired, 1);
+    timer.reset();
+    for (int i = 0; i < 4; i++)
+        wheel.advance();
+    CHECK_EQUAL(fired, 2);
+}
+
+TEST(timerWheelHandlesTimersLongerThanItsSlots) {
+    TimerWheel wheel(tickInterval, 4);
+    int fired = 0;
+    Timer timer(10 * tickInterval, [&fired]() { fired++; }, &wheel);
+    for (int i = 0; i < 9; i++)
+        wheel.advance();
+    CHECK_EQUAL(fired, 0);
+    wheel.advance();
+    CHECK_EQUAL(fired, 1);
+}
+
+TEST(timerWheelKeepsProgressOfPausedTimers) {
+    TimerWheel wheel(tickInterval);
+    int fired = 0;
+    Timer timer(0.5f, [&fired]() { fired++; }, &wheel);
+    wheel.advance();
+    timer.setRunning(false);
+    for (int i = 0; i < 10; i++)
+        wheel.advance();
+    CHECK_EQUAL(fired, 0);
+    CHECK_EQUAL(timer.timeElapsed(), tickInterval);
+
+    timer.setRunning(true);
+    for (int i = 0; i < 2; i++)
+        wheel.advance();
+    CHECK_EQUAL(fired, 0);
+    wheel.advance();
+    CHECK_EQUAL(fired, 1);
+}
+
+TEST(timerWheelForgetsDestroyedTimers) {
+    TimerWheel wheel(tickInterval);
+    int fired = 0;
+    std::optional<Timer> timer;
+    timer.emplace(0.25f, [&fired]() { fired++; }, &wheel);
+    Timer other(0.25f, [&fired]() { fired += 10; }, &wheel);
+    timer.reset();
+    for (int i = 0; i < 4; i++)
+        wheel.advance();
+    CHECK_EQUAL(fired, 10);
+}
+
+TEST(timerWheelMatchesUpdatedTimers) {
+    TimerWheel wheel(tickInterval);
+    int wheelFired = 0;
+    int updatedFired = 0;
+    Timer onWheel(0.75f, [&wheelFired]() { wheelFired++; }, &wheel);
+    Timer updated(0.75f, [&updatedFired]() { updatedFired++; });
+    for (int i = 0; i < 12; i++) {
+        wheel.advance();
+        updated.update(tickInterval);
+        CHECK_EQUAL(wheelFired, updatedFired);
+        CHECK_EQUAL(onWheel.timeElapsed(), updated.timeElapsed());
+    }
+    CHECK_EQUAL(wheelFired, 1);
+
+    // saved progress carries over to a wheel driven timer
+    updated.reset();
+    updated.update(2 * tickInterval);
+    onWheel.loadState(updated.saveState());
+    CHECK_EQUAL(onWheel.timeElapsed(), 2 * tickInterval);
+}
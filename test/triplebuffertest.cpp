@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "simulationthread.hpp"
+#include "triplebuffer.hpp"
+#include "test.hpp"
+
+TEST(tripleBufferHandsOverTheLatestValue) {
+    TripleBuffer<int> buffer;
+    CHECK(!buffer.update());
+
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    CHECK(buffer.update());
+    CHECK_EQUAL(buffer.readBuffer(), 1);
+    CHECK(!buffer.update());
+    CHECK_EQUAL(buffer.readBuffer(), 1);
+
+    // values published while the reader was busy are skipped
+    buffer.writeBuffer() = 2;
+    buffer.publish();
+    buffer.writeBuffer() = 3;
+    buffer.publish();
+    CHECK(&buffer.writeBuffer() != &buffer.readBuffer());
+    CHECK(buffer.update());
+    CHECK_EQUAL(buffer.readBuffer(), 3);
+}
+
+TEST(tripleBufferNeverTearsValues) {
+    struct Value {
+        uint64_t sequence = 0;
+        // written separately, a torn value wouldn't match its sequence
+        uint64_t square = 0;
+    };
+    constexpr uint64_t published = 200000;
+    TripleBuffer<Value> buffer;
+
+    std::thread writer([&buffer]() {
+        for (uint64_t i = 1; i <= published; i++) {
+            Value& value = buffer.writeBuffer();
+            value.sequence = i;
+            value.square = i * i;
+            buffer.publish();
+        }
+    });
+    uint64_t last = 0;
+    bool consistent = true;
+    bool ordered = true;
+    while (last < published) {
+        if (!buffer.update())
+            continue;
+        const Value& value = buffer.readBuffer();
+        consistent = consistent && value.square == value.sequence * value.sequence;
+        ordered = ordered && value.sequence > last;
+        last = value.sequence;
+    }
+    writer.join();
+    CHECK(consistent);
+    CHECK(ordered);
+}
+
+TEST(simulationThreadPublishesFrames) {
+    Simulation simulation;
+    SimulationThread thread(simulation);
+    const RenderFrame *frame = &thread.latestFrame();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (frame->tick < 10 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        frame = &thread.latestFrame();
+    }
+    CHECK(frame->tick >= 10u);
+    CHECK(frame->current.size() > 0u);
+    float alpha = frame->alphaAt(std::chrono::steady_clock::now());
+    CHECK(alpha >= 0.0f && alpha <= 1.0f);
+}
@@ -0,0 +1,81 @@
+#include <deque>
+#include <memory>
+
+#include "rendercommands.hpp"
+#include "wall.hpp"
+#include "walllayer.hpp"
+#include "world.hpp"
+#include "test.hpp"
+
+using Type = RenderCommand::Type;
+
+// a row of 1 by 1 walls, 2 meters apart
+static void addWalls(b2World& world, std::deque<Wall>& walls, int count) {
+    for (int i = 0; i < count; i++)
+        walls.emplace_back(world, b2Vec2{2.0f * walls.size(), 0}, b2Vec2{1, 1});
+}
+
+TEST(wallLayerRecordsOneCommandWhenCached) {
+    b2World world(b2Vec2{0, 0});
+    std::deque<Wall> walls;
+    addWalls(world, walls, 50);
+    WallLayer layer;
+    RenderCommandBuffer commands;
+    layer.render(commands, walls);
+    REQUIRE(commands.size() == 1u);
+    CHECK_EQUAL(commands.count(Type::CACHED_LAYER), 1u);
+    std::shared_ptr<const WallOutlines> outlines = commands.getCachedLayer(commands.view()[0]);
+    CHECK_EQUAL(outlines->commands.count(Type::RECTANGLE_LINES), 50u);
+
+    // the same outlines until the layer is invalidated
+    addWalls(world, walls, 1);
+    commands.clear();
+    layer.render(commands, walls);
+    REQUIRE(commands.size() == 1u);
+    CHECK(commands.getCachedLayer(commands.view()[0]) == outlines);
+
+    layer.invalidate();
+    commands.clear();
+    layer.render(commands, walls);
+    REQUIRE(commands.size() == 1u);
+    CHECK(commands.getCachedLayer(commands.view()[0]) != outlines);
+    CHECK_EQUAL(commands.getCachedLayer(commands.view()[0])->commands.count(Type::RECTANGLE_LINES), 51u);
+}
+
+TEST(wallLayerDrawsWallsOneByOneWithoutCaching) {
+    b2World world(b2Vec2{0, 0});
+    std::deque<Wall> walls;
+    addWalls(world, walls, 50);
+    WallLayer layer;
+    RenderCommandBuffer commands;
+    WallLayer::setCachingEnabled(false);
+    layer.render(commands, walls);
+    CHECK_EQUAL(commands.count(Type::CACHED_LAYER), 0u);
+    CHECK_EQUAL(commands.count(Type::RECTANGLE_LINES), 50u);
+
+    // only the walls overlapping the view, the first five
+    Rectangle view = {-5, -5, metersToPixels(9), 20};
+    commands.clear();
+    layer.render(commands, walls, &view);
+    CHECK_EQUAL(commands.count(Type::RECTANGLE_LINES), 5u);
+    WallLayer::setCachingEnabled(true);
+}
+
+TEST(wallLayerSkipsViewsMissingIt) {
+    b2World world(b2Vec2{0, 0});
+    std::deque<Wall> walls;
+    addWalls(world, walls, 10);
+    WallLayer layer;
+    RenderCommandBuffer commands;
+    Rectangle view = {0, metersToPixels(10), 100, 100};
+    layer.render(commands, walls, &view);
+    CHECK_EQUAL(commands.size(), 0u);
+
+    // too wide for a texture, drawn one by one even when caching
+    std::deque<Wall> wide;
+    wide.emplace_back(world, b2Vec2{0, 0}, b2Vec2{1000, 1});
+    WallLayer wideLayer;
+    wideLayer.render(commands, wide);
+    CHECK_EQUAL(commands.count(Type::CACHED_LAYER), 0u);
+    CHECK_EQUAL(commands.count(Type::RECTANGLE_LINES), 1u);
+}
@@ -0,0 +1,75 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "batchsimulation.hpp"
+#include "headless.hpp"
+#include "workstealingpool.hpp"
+#include "test.hpp"
+
+TEST(workStealingPoolRunsEveryIndexOnce) {
+    WorkStealingPool pool(4);
+    CHECK_EQUAL(pool.threadCount(), 4u);
+    for (size_t count: {0, 1, 3, 1000}) {
+        std::vector<std::atomic<int>> calls(count);
+        pool.parallelFor(count, [&calls](size_t i) { calls[i]++; });
+        for (size_t i = 0; i < count; i++)
+            CHECK_EQUAL(calls[i].load(), 1);
+    }
+}
+
+TEST(workStealingPoolBalancesUnevenWork) {
+    WorkStealingPool pool(4);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    // all the slow indices land in the first thread's range, the others
+    // can only help by stealing them
+    pool.parallelFor(64, [&](size_t i) {
+        if (i < 16)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        std::lock_guard lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+    CHECK(threads.size() > 1);
+}
+
+TEST(workStealingPoolRethrowsTheFirstException) {
+    WorkStealingPool pool(3);
+    std::atomic<int> calls = 0;
+    CHECK_THROWS(pool.parallelFor(100, [&calls](size_t i) {
+        calls++;
+        if (i == 42) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+    CHECK_EQUAL(calls.load(), 100);
+
+    // and is usable afterwards
+    calls = 0;
+    pool.parallelFor(10, [&calls](size_t) { calls++; });
+    CHECK_EQUAL(calls.load(), 10);
+}
+
+TEST(batchSimulationMatchesSequentialRuns) {
+    constexpr uint64_t ticks = 300;
+    auto input = [](size_t worldIndex, Simulation& simulation) {
+        simulation.applyInput(0, scriptedInput(simulation.tick() + worldIndex * 13));
+    };
+    BatchSimulation batch(6, 1, {}, 3);
+    batch.run(ticks, input);
+
+    for (size_t world = 0; world < batch.size(); world++) {
+        Simulation alone;
+        for (uint64_t i = 0; i < ticks; i++) {
+            input(world, alone);
+            alone.step();
+        }
+        std::vector<uint8_t> expected;
+        std::vector<uint8_t> actual;
+        alone.saveState(expected);
+        batch.at(world).saveState(actual);
+        CHECK(actual == expected);
+    }
+}